@@ -0,0 +1,508 @@
+/**
+ * World benchmark.
+ * Builds synthetic worlds with N asteroids of each size and M bullets and
+ * times the phases of a tick: entity update, collision, reclaim of the
+ * dead, snapshot and render list.
+ * The world is topped back up to N and M before every tick.
+ * add/remove are timed on their own. Every configuration prints one JSON
+ * object per line on stdout so runs can be diffed and plotted.
+ *
+ * Before the sweep the motion and narrowphase kernels are run next to their
+ * scalar references on the same entities, the bench fails (exit 1) if they
+ * differ by a single bit.
+ *
+ * usage: bench                          default sweep
+ *        bench perSize bullets [ticks]  one configuration
+ *
+ * Allocations are counted by wrapping malloc/calloc/realloc at link time,
+ * see the bench target of the Makefile.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "world.h"
+#include "entity.h"
+#include "render_list.h"
+#include "motion.h"
+#include "narrowphase.h"
+#include "simd.h"
+
+
+#define BENCH_SEED 12345
+#define WARMUP_TICKS 5
+#define CHURN_OPS 1024
+
+// Ticks timed for a configuration, fewer for the big worlds
+#define TICK_BUDGET 2000000
+#define MIN_TICKS 10
+#define MAX_TICKS 1000
+
+// Motion kernel check, an odd count so the scalar tail runs too
+#define MOTION_ENTITIES 10001
+#define MOTION_TICKS 200
+
+// Narrowphase check: queries, each against a batch of nearby circles
+#define NARROWPHASE_QUERIES 200000
+#define NARROWPHASE_SPREAD 300.0f
+
+// Same drawable as the page
+#define BENCH_WIDTH 1000
+#define BENCH_HEIGHT 1000
+
+
+/* ====================== ALLOCATION COUNTING ====================== */
+
+static long allocCount = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  allocCount++;
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+  allocCount++;
+  return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* p, size_t size) {
+  allocCount++;
+  return __real_realloc(p, size);
+}
+
+
+/* ============================ HELPERS ============================ */
+
+static long long nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static float randomCoord(Rng* rng) {
+  return rngFloat(rng) * 2.0f * BOUNDARY_LIMIT - BOUNDARY_LIMIT;
+}
+
+static int compareLongLong(const void* a, const void* b) {
+  long long x = *(const long long*)a;
+  long long y = *(const long long*)b;
+  return (x > y) - (x < y);
+}
+
+static void addAsteroidAnywhere(World* w, int lives) {
+  Entity a;
+  if (lives == 3) {
+    initAsteroid0(&w->rng, &a);
+  } else if (lives == 2) {
+    initAsteroid1(&w->rng, &a);
+  } else {
+    initAsteroid2(&w->rng, &a);
+  }
+  a.x = randomCoord(&w->rng);
+  a.y = randomCoord(&w->rng);
+  addEntity(w, &a);
+}
+
+// Bullets and asteroids die on their first hit and splits pile up small
+// asteroids. The world is put back to perSize asteroids of each size and the
+// full bullet budget between ticks, outside the timed part, so every tick
+// runs on the configured world
+static void topUpWorld(World* w, int perSize) {
+  EntityStore* s = &w->entities;
+
+  int sizes[4] = {0, 0, 0, 0};
+  int i = 0;
+  while (i < s->count) {
+    int lives = s->lives[i];
+    if (s->type[i] == ASTEROID && lives > 0 && lives <= 3) {
+      if (sizes[lives] == perSize) {
+        removeEntity(w, i);
+        continue;
+      }
+      sizes[lives]++;
+    }
+    i++;
+  }
+  for (int lives = 3; lives >= 1; lives--) {
+    for (int k = sizes[lives]; k < perSize && hasRoom(w, ASTEROID, 1); k++) {
+      addAsteroidAnywhere(w, lives);
+    }
+  }
+
+  int player = storeIndex(s, w->player);
+  float angle = s->angle[player];
+
+  while (w->budget[BULLET].count < w->budget[BULLET].capacity) {
+    s->angle[player] = rngFloat(&w->rng) * 2.0f * (float)M_PI;
+
+    Entity b;
+    initBullet(s, player, &b);
+    b.x = randomCoord(&w->rng);
+    b.y = randomCoord(&w->rng);
+    addEntity(w, &b);
+  }
+
+  s->angle[player] = angle;
+}
+
+// Asteroids of the three sizes and bullets spread over the whole world
+static void buildSyntheticWorld(World* w, int perSize, int bullets) {
+  // a split turns one asteroid into two, leave room for them, the spawns
+  // and the add/remove churn
+  initWorldSized(w, BENCH_SEED, bullets, 4 * perSize + 64 + CHURN_OPS);
+
+  EntityStore* s = &w->entities;
+  int player = storeIndex(s, w->player);
+
+  // the ship must survive the field, a restart would empty the world
+  s->lives[player] = 1 << 30;
+
+  topUpWorld(w, perSize);
+}
+
+
+/* ========================= MOTION KERNEL ========================= */
+
+// Entities of every type with speeds above the ship limit, positions all
+// over the world so plenty of them wrap. Both stores get the same values
+static void fillMotionStores(EntityStore* a, EntityStore* b, Rng* rng, int n) {
+  for (int k = 0; k < n; k++) {
+    EntityHandle h;
+    int i = storeCreate(a, &h);
+    int j = storeCreate(b, &h);
+
+    a->type[i] = b->type[j] = (int)rngBelow(rng, 3);
+    a->lives[i] = b->lives[j] = 1 << 20;
+    a->x[i] = b->x[j] = randomCoord(rng);
+    a->y[i] = b->y[j] = randomCoord(rng);
+    a->vx[i] = b->vx[j] = (rngFloat(rng) - 0.5f) * 4.0f * MAX_VELOCITY;
+    a->vy[i] = b->vy[j] = (rngFloat(rng) - 0.5f) * 4.0f * MAX_VELOCITY;
+  }
+}
+
+// Same acceleration in both stores, like moveForward every tick
+static void accelerateMotionStores(EntityStore* a, EntityStore* b, Rng* rng) {
+  for (int i = 0; i < a->count; i++) {
+    a->ax[i] = b->ax[i] = (rngFloat(rng) - 0.5f) * 2.0f * ACCELERATION;
+    a->ay[i] = b->ay[i] = (rngFloat(rng) - 0.5f) * 2.0f * ACCELERATION;
+  }
+}
+
+static int differingEntities(const EntityStore* a, const EntityStore* b) {
+  int differ = 0;
+  for (int i = 0; i < a->count; i++) {
+    if (memcmp(&a->x[i], &b->x[i], sizeof(float)) != 0 ||
+        memcmp(&a->y[i], &b->y[i], sizeof(float)) != 0 ||
+        memcmp(&a->vx[i], &b->vx[i], sizeof(float)) != 0 ||
+        memcmp(&a->vy[i], &b->vy[i], sizeof(float)) != 0 ||
+        memcmp(&a->ax[i], &b->ax[i], sizeof(float)) != 0 ||
+        memcmp(&a->ay[i], &b->ay[i], sizeof(float)) != 0 ||
+        a->lives[i] != b->lives[i]) {
+      differ++;
+    }
+  }
+  return differ;
+}
+
+// Runs integrateMotion and integrateMotionScalar side by side, returns
+// false if they ever disagree
+static bool checkMotionKernel(void) {
+  EntityStore kernel, scalar;
+  if (!initEntityStore(&kernel, MOTION_ENTITIES) || !initEntityStore(&scalar, MOTION_ENTITIES)) {
+    exit(1);
+  }
+
+  Rng rng;
+  seedRng(&rng, BENCH_SEED);
+  fillMotionStores(&kernel, &scalar, &rng, MOTION_ENTITIES);
+
+  // a 60 Hz tick and an uneven one, the drag goes through powf
+  const float dts[2] = {1.0f / 60.0f, 1.0f / 144.0f};
+  long long kernelNs = 0;
+  long long scalarNs = 0;
+  int mismatches = 0;
+
+  for (int t = 0; t < MOTION_TICKS; t++) {
+    float dt = dts[t % 2];
+    accelerateMotionStores(&kernel, &scalar, &rng);
+
+    long long t0 = nowNs();
+    integrateMotion(&kernel, dt);
+    long long t1 = nowNs();
+    integrateMotionScalar(&scalar, 0, scalar.count, dt);
+    long long t2 = nowNs();
+
+    kernelNs += t1 - t0;
+    scalarNs += t2 - t1;
+    mismatches += differingEntities(&kernel, &scalar);
+  }
+
+  double perEntity = (double)MOTION_TICKS * MOTION_ENTITIES;
+  printf("{\"motion_lanes\": %d, \"entities\": %d, \"ticks\": %d, "
+         "\"kernel_ns_per_entity\": %.2f, \"scalar_ns_per_entity\": %.2f, "
+         "\"mismatches\": %d}\n",
+         SIMD_LANES, MOTION_ENTITIES, MOTION_TICKS,
+         kernelNs / perEntity, scalarNs / perEntity, mismatches);
+  fflush(stdout);
+
+  freeEntityStore(&kernel);
+  freeEntityStore(&scalar);
+
+  if (mismatches != 0) {
+    printf("ERROR: the motion kernel differs from updatePosition\n");
+    return false;
+  }
+  return true;
+}
+
+
+/* ========================== NARROWPHASE ========================== */
+
+// Runs collideCircles and checkCollision on the same pairs, returns false
+// if a single bit of the hit masks differs
+static bool checkNarrowphase(void) {
+  EntityStore s;
+  if (!initEntityStore(&s, NARROWPHASE_BATCH + 1)) {
+    exit(1);
+  }
+
+  Rng rng;
+  seedRng(&rng, BENCH_SEED);
+
+  float xs[NARROWPHASE_BATCH];
+  float ys[NARROWPHASE_BATCH];
+  float rs[NARROWPHASE_BATCH];
+
+  long long kernelNs = 0;
+  long long scalarNs = 0;
+  long hits = 0;
+  int mismatches = 0;
+
+  for (int q = 0; q < NARROWPHASE_QUERIES; q++) {
+    // a bullet or the ship, then asteroids around it, some across an edge
+    EntityHandle h;
+    int query = storeCreate(&s, &h);
+    s.type[query] = (int)rngBelow(&rng, 2);
+    s.x[query] = randomCoord(&rng);
+    s.y[query] = randomCoord(&rng);
+    s.radius[query] = radiusOf(s.type[query], 1);
+
+    int n = 1 + (int)rngBelow(&rng, NARROWPHASE_BATCH);
+    for (int k = 0; k < n; k++) {
+      int i = storeCreate(&s, &h);
+      s.type[i] = ASTEROID;
+      s.x[i] = xs[k] = wrapDelta(s.x[query] + (rngFloat(&rng) - 0.5f) * NARROWPHASE_SPREAD);
+      s.y[i] = ys[k] = wrapDelta(s.y[query] + (rngFloat(&rng) - 0.5f) * NARROWPHASE_SPREAD);
+      s.radius[i] = rs[k] = radiusOf(ASTEROID, 1 + (int)rngBelow(&rng, 3));
+    }
+
+    long long t0 = nowNs();
+    uint32_t mask = collideCircles(s.x[query], s.y[query], s.radius[query], xs, ys, rs, n);
+    long long t1 = nowNs();
+    uint32_t expected = 0;
+    for (int k = 0; k < n; k++) {
+      if (checkCollision(&s, query, 1 + k)) {
+        expected |= 1u << k;
+      }
+    }
+    long long t2 = nowNs();
+
+    kernelNs += t1 - t0;
+    scalarNs += t2 - t1;
+    hits += __builtin_popcount(expected);
+    if (mask != expected) {
+      mismatches++;
+    }
+
+    // the store hands out slots again on the next query
+    while (s.count > 0) {
+      storeRemove(&s, s.count - 1);
+    }
+  }
+
+  printf("{\"narrowphase_lanes\": %d, \"queries\": %d, \"hits\": %ld, "
+         "\"kernel_ns_per_query\": %.2f, \"scalar_ns_per_query\": %.2f, "
+         "\"mismatches\": %d}\n",
+         SIMD_LANES, NARROWPHASE_QUERIES, hits,
+         (double)kernelNs / NARROWPHASE_QUERIES, (double)scalarNs / NARROWPHASE_QUERIES,
+         mismatches);
+  fflush(stdout);
+
+  freeEntityStore(&s);
+
+  if (mismatches != 0) {
+    printf("ERROR: collideCircles differs from checkCollision\n");
+    return false;
+  }
+  return true;
+}
+
+
+/* ============================ BENCHMARK ============================ */
+
+static void runConfiguration(int perSize, int bullets, int ticks) {
+  World w;
+  buildSyntheticWorld(&w, perSize, bullets);
+  EntityStore* s = &w.entities;
+
+  RenderList list;
+  initRenderList(&list);
+
+  SnapshotBuffer snapshots;
+  if (!initSnapshotBuffer(&snapshots, s->capacity)) {
+    exit(1);
+  }
+
+  float dt = w.tickDt;
+  int entitiesStart = s->count;
+
+  // add then swap-remove at random indices, on the fresh world
+  int churn = CHURN_OPS;
+  if (churn > w.budget[ASTEROID].capacity - w.budget[ASTEROID].count) {
+    churn = w.budget[ASTEROID].capacity - w.budget[ASTEROID].count;
+  }
+
+  long long c0 = nowNs();
+  for (int k = 0; k < churn; k++) {
+    Entity a;
+    initAsteroid2(&w.rng, &a);
+    addEntity(&w, &a);
+  }
+  long long c1 = nowNs();
+  for (int k = 0; k < churn; k++) {
+    // index 0 is kept, it may be the ship
+    removeEntity(&w, 1 + rngBelow(&w.rng, s->count - 1));
+  }
+  long long c2 = nowNs();
+
+  for (int t = 0; t < WARMUP_TICKS; t++) {
+    topUpWorld(&w, perSize);
+    updateEntities(&w, dt);
+    spawnAsteroids(&w);
+    collisionDetection(&w);
+    reclaimDeadEntities(&w);
+    publishSnapshot(&snapshots, &w, 0.0);
+    clearRenderList(&list);
+    buildRenderList(&list, latestSnapshot(&snapshots), 1.0f, BENCH_WIDTH, BENCH_HEIGHT);
+  }
+
+  long long* tickNs = malloc(sizeof(long long) * ticks);
+  if (!tickNs) {
+    printf("ERROR: Out of memory in function runConfiguration\n");
+    exit(1);
+  }
+
+  double updatePerEntity = 0.0;
+  double collidePerEntity = 0.0;
+  double reclaimPerEntity = 0.0;
+  double renderPerEntity = 0.0;
+  double tickPerEntity = 0.0;
+  long long pairs = 0;
+  long allocsBefore = allocCount;
+
+  for (int t = 0; t < ticks; t++) {
+    topUpWorld(&w, perSize);
+    int n = s->count > 0 ? s->count : 1;
+
+    long long t0 = nowNs();
+    w.simTime += dt;
+    updateEntities(&w, dt);
+    long long t1 = nowNs();
+    spawnAsteroids(&w);
+    collisionDetection(&w);
+    long long t2 = nowNs();
+    reclaimDeadEntities(&w);
+    long long t3 = nowNs();
+    publishSnapshot(&snapshots, &w, 0.0);
+    clearRenderList(&list);
+    buildRenderList(&list, latestSnapshot(&snapshots), 1.0f, BENCH_WIDTH, BENCH_HEIGHT);
+    long long t4 = nowNs();
+
+    updatePerEntity += (double)(t1 - t0) / n;
+    collidePerEntity += (double)(t2 - t1) / n;
+    reclaimPerEntity += (double)(t3 - t2) / n;
+    renderPerEntity += (double)(t4 - t3) / n;
+    tickPerEntity += (double)(t4 - t0) / n;
+    tickNs[t] = t4 - t0;
+    pairs += w.collisionPairs;
+  }
+
+  long allocs = allocCount - allocsBefore;
+  int entitiesEnd = s->count;
+
+  qsort(tickNs, ticks, sizeof(long long), compareLongLong);
+  long long p50 = tickNs[ticks / 2];
+  long long p99 = tickNs[(ticks * 99) / 100 < ticks ? (ticks * 99) / 100 : ticks - 1];
+
+  printf("{\"asteroids_per_size\": %d, \"bullets\": %d, "
+         "\"entities_start\": %d, \"entities_end\": %d, \"ticks\": %d, "
+         "\"update_ns_per_entity\": %.2f, \"collide_ns_per_entity\": %.2f, "
+         "\"reclaim_ns_per_entity\": %.2f, \"render_ns_per_entity\": %.2f, \"tick_ns_per_entity\": %.2f, "
+         "\"tick_p50_us\": %.2f, \"tick_p99_us\": %.2f, "
+         "\"collision_pairs_per_tick\": %.1f, "
+         "\"add_ns\": %.1f, \"remove_ns\": %.1f, "
+         "\"allocs_per_tick\": %.3f}\n",
+         perSize, bullets, entitiesStart, entitiesEnd, ticks,
+         updatePerEntity / ticks, collidePerEntity / ticks,
+         reclaimPerEntity / ticks, renderPerEntity / ticks, tickPerEntity / ticks,
+         p50 / 1000.0, p99 / 1000.0,
+         (double)pairs / ticks,
+         churn > 0 ? (double)(c1 - c0) / churn : 0.0,
+         churn > 0 ? (double)(c2 - c1) / churn : 0.0,
+         (double)allocs / ticks);
+  fflush(stdout);
+
+  free(tickNs);
+  freeRenderList(&list);
+  freeSnapshotBuffer(&snapshots);
+  freeWorld(&w);
+}
+
+static int ticksFor(int entities) {
+  int ticks = TICK_BUDGET / (entities > 0 ? entities : 1);
+  if (ticks < MIN_TICKS) ticks = MIN_TICKS;
+  if (ticks > MAX_TICKS) ticks = MAX_TICKS;
+  return ticks;
+}
+
+int main(int argc, char** argv) {
+  if (!checkMotionKernel() || !checkNarrowphase()) {
+    return 1;
+  }
+
+  if (argc >= 3) {
+    int perSize = atoi(argv[1]);
+    int bullets = atoi(argv[2]);
+    int ticks = argc >= 4 ? atoi(argv[3]) : ticksFor(3 * perSize + bullets);
+    if (perSize < 0 || bullets < 0 || ticks <= 0) {
+      printf("usage: %s [perSize bullets [ticks]]\n", argv[0]);
+      return 1;
+    }
+    runConfiguration(perSize, bullets, ticks);
+    return 0;
+  }
+
+  // from a few hundred entities to about 100k
+  const int sweep[][2] = {
+    {100, 64},
+    {300, 100},
+    {1000, 300},
+    {3000, 1000},
+    {10000, 3000},
+    {30000, 10000},
+  };
+  int count = sizeof(sweep) / sizeof(sweep[0]);
+
+  for (int c = 0; c < count; c++) {
+    int perSize = sweep[c][0];
+    int bullets = sweep[c][1];
+    runConfiguration(perSize, bullets, ticksFor(3 * perSize + bullets));
+  }
+  return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * Asset bundle reader.
+ * The file is mapped by the platform and its index validated once, every
+ * lookup after that is a pointer into the mapping.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "asset_bundle.h"
+#include "platform.h"
+
+
+static void resetBundle(AssetBundle* b) {
+  b->data = NULL;
+  b->size = 0;
+  b->entries = NULL;
+  b->count = 0;
+}
+
+// Every entry has to lie inside the file, the pixels are used unchecked
+static bool validBundle(const uint8_t* data, size_t size) {
+  if (size < sizeof(BundleHeader)) {
+    return false;
+  }
+
+  const BundleHeader* h = (const BundleHeader*)data;
+  if (h->magic != BUNDLE_MAGIC || h->version != BUNDLE_VERSION || h->size != size) {
+    return false;
+  }
+  if (h->count > (size - sizeof(BundleHeader)) / sizeof(BundleEntry)) {
+    return false;
+  }
+
+  const BundleEntry* entries = (const BundleEntry*)(data + sizeof(BundleHeader));
+  for (uint32_t i = 0; i < h->count; i++) {
+    const BundleEntry* e = &entries[i];
+    if (memchr(e->name, '\0', BUNDLE_NAME_SIZE) == NULL ||
+        e->size == 0 || (uint64_t)e->width * e->height * 4 != e->size ||
+        e->offset % BUNDLE_ALIGNMENT != 0 ||
+        (uint64_t)e->offset + e->size > size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool openBundle(AssetBundle* b, const char* path) {
+  resetBundle(b);
+
+  size_t size;
+  const void* data = platformMapFile(path, &size);
+  if (!data) {
+    printf("Failed to open asset bundle %s\n", path);
+    return false;
+  }
+
+  if (!validBundle(data, size)) {
+    printf("ERROR: %s is not a version %d asset bundle, run make bundle\n",
+           path, BUNDLE_VERSION);
+    platformUnmapFile(data, size);
+    return false;
+  }
+
+  b->data = data;
+  b->size = size;
+  b->entries = (const BundleEntry*)(b->data + sizeof(BundleHeader));
+  b->count = (int)((const BundleHeader*)data)->count;
+  return true;
+}
+
+void closeBundle(AssetBundle* b) {
+  if (b->data) {
+    platformUnmapFile(b->data, b->size);
+  }
+  resetBundle(b);
+}
+
+const BundleEntry* findAsset(const AssetBundle* b, const char* name) {
+  for (int i = 0; i < b->count; i++) {
+    if (strncmp(b->entries[i].name, name, BUNDLE_NAME_SIZE) == 0) {
+      return &b->entries[i];
+    }
+  }
+  return NULL;
+}
+
+const uint8_t* assetPixels(const AssetBundle* b, const BundleEntry* e) {
+  return b->data + e->offset;
+}
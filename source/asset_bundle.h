@@ -0,0 +1,62 @@
+#ifndef ASSET_BUNDLE_H
+#define ASSET_BUNDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Every image the game draws, baked offline by tools/bake_assets.c into one
+// file of GPU ready pixels: RGBA8 with premultiplied alpha. Rows keep the
+// order of the PNG, top first, unflipped: GL takes the first row as t = 0,
+// which is what the atlas UVs written by tools/pack_atlas.c expect.
+// Loading is mapping the file and pointing at the pixels, nothing is
+// decoded at runtime.
+//
+// Layout, little endian:
+//   BundleHeader
+//   BundleEntry[count]
+//   pixels of each entry, at its offset, BUNDLE_ALIGNMENT aligned
+
+// Written by make bundle, preloaded at the same path in the browser
+#define ASSET_BUNDLE_PATH "build/asteroid.pak"
+
+#define BUNDLE_MAGIC 0x4b505341u      // "ASPK"
+#define BUNDLE_VERSION 1
+#define BUNDLE_NAME_SIZE 24
+#define BUNDLE_ALIGNMENT 16
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;         // entries in the index
+    uint32_t size;          // of the whole file
+} BundleHeader;
+
+typedef struct {
+    char name[BUNDLE_NAME_SIZE];    // file name without extension
+    uint32_t width;
+    uint32_t height;
+    uint32_t offset;        // of the pixels, from the start of the file
+    uint32_t size;          // width * height * 4
+} BundleEntry;
+
+typedef struct {
+    const uint8_t* data;    // the whole file, read only
+    size_t size;
+    const BundleEntry* entries;
+    int count;
+} AssetBundle;
+
+
+// Maps the bundle and checks its index, false if it is missing or damaged
+bool openBundle(AssetBundle* b, const char* path);
+void closeBundle(AssetBundle* b);
+
+// NULL if the bundle has no asset of that name
+const BundleEntry* findAsset(const AssetBundle* b, const char* name);
+
+// Pixels of an entry, straight from the mapped file
+const uint8_t* assetPixels(const AssetBundle* b, const BundleEntry* e);
+
+
+#endif
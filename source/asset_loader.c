@@ -0,0 +1,77 @@
+/**
+ * Asset loading phase.
+ * The bundle needs no decoding, what is left off the main thread is getting
+ * its bytes in memory: faulting the mapping in natively, copying it out of
+ * asteroid.data in the browser. The loader only publishes its result
+ * through the read flag, nothing else is shared until it is joined.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "asset_loader.h"
+#include "platform.h"
+#include "startup.h"
+
+
+// Pages the uploads will read, one byte each is enough to fault them in
+#define PAGE_SIZE 4096
+
+static void readBundle(AssetLoader* l) {
+  l->readBegin = platformWallNow();
+  l->ok = openBundle(&l->bundle, l->path);
+  if (l->ok) {
+    const volatile uint8_t* data = l->bundle.data;
+    for (size_t i = 0; i < l->bundle.size; i += PAGE_SIZE) {
+      (void)data[i];
+    }
+  }
+  l->readEnd = platformWallNow();
+  atomic_store_explicit(&l->read, true, memory_order_release);
+}
+
+#ifdef SIM_THREAD
+static void* assetLoaderMain(void* arg) {
+  readBundle(arg);
+  return NULL;
+}
+#endif
+
+void startAssetLoad(AssetLoader* l, const char* path) {
+  l->path = path;
+  l->ok = false;
+  l->threaded = false;
+  l->joined = false;
+  atomic_store(&l->read, false);
+
+#ifdef SIM_THREAD
+  if (pthread_create(&l->thread, NULL, assetLoaderMain, l) == 0) {
+    l->threaded = true;
+    return;
+  }
+  printf("Error creating the asset loader thread in function startAssetLoad\n");
+#endif
+
+  // no thread, the read is part of startup
+  readBundle(l);
+}
+
+bool assetsRead(AssetLoader* l) {
+  if (!atomic_load_explicit(&l->read, memory_order_acquire)) {
+    return false;
+  }
+
+  if (!l->joined) {
+    // the thread is done, the join returns right away
+    if (l->threaded) {
+      pthread_join(l->thread, NULL);
+    }
+    l->joined = true;
+    startupStage(STARTUP_ASSETS, l->readBegin, l->readEnd);
+  }
+  return true;
+}
+
+void finishAssetLoad(AssetLoader* l) {
+  closeBundle(&l->bundle);
+}
@@ -0,0 +1,38 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "asset_bundle.h"
+
+// Loading phase of the assets. In SIM_THREAD builds the bundle is mapped
+// and checked on a thread of its own while main sets up the world, without
+// threads it is done by startAssetLoad. The frame polls assetsRead and does
+// the GL uploads itself, a budget at a time (uploadTextures).
+typedef struct {
+    const char* path;
+    AssetBundle bundle;
+    bool ok;                // the bundle could be opened
+
+    double readBegin;       // platformWallNow around openBundle
+    double readEnd;
+
+    _Atomic bool read;      // set by the loader once bundle and ok are final
+    bool threaded;          // the read runs on thread
+    bool joined;            // the result was taken by assetsRead
+    pthread_t thread;
+} AssetLoader;
+
+
+void startAssetLoad(AssetLoader* l, const char* path);
+
+// Never blocks: false while the bundle is being read. The first time it
+// returns true it joins the loader and records the assets stage
+bool assetsRead(AssetLoader* l);
+
+// Unmaps the bundle once every asset is uploaded
+void finishAssetLoad(AssetLoader* l);
+
+
+#endif
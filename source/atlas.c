@@ -0,0 +1,33 @@
+// Generated by tools/pack_atlas.c, do not edit.
+
+#include "atlas.h"
+
+const int atlasWidth = 1004;
+const int atlasHeight = 336;
+
+const float atlasRects[SPRITE_COUNT][4] = {
+    [SPRITE_SHIP] = {0.75498009f, 0.00595238f, 0.80079681f, 0.16071428f},
+    [SPRITE_BULLET] = {0.22111554f, 0.90476191f, 0.23107570f, 0.93452382f},
+    [SPRITE_ASTEROID0] = {0.00199203f, 0.00595238f, 0.30079681f, 0.89880955f},
+    [SPRITE_ASTEROID1] = {0.60358566f, 0.00595238f, 0.75298804f, 0.45238096f},
+    [SPRITE_ASTEROID2] = {0.30278885f, 0.00595238f, 0.60159361f, 0.89880955f},
+    [SPRITE_GLYPH_FIRST + 0] = {0.80278885f, 0.00595238f, 0.82270914f, 0.08928572f},  // '0'
+    [SPRITE_GLYPH_FIRST + 1] = {0.82470119f, 0.00595238f, 0.84462154f, 0.08928572f},  // '1'
+    [SPRITE_GLYPH_FIRST + 2] = {0.84661353f, 0.00595238f, 0.86653388f, 0.08928572f},  // '2'
+    [SPRITE_GLYPH_FIRST + 3] = {0.86852592f, 0.00595238f, 0.88844621f, 0.08928572f},  // '3'
+    [SPRITE_GLYPH_FIRST + 4] = {0.89043826f, 0.00595238f, 0.91035855f, 0.08928572f},  // '4'
+    [SPRITE_GLYPH_FIRST + 5] = {0.91235059f, 0.00595238f, 0.93227094f, 0.08928572f},  // '5'
+    [SPRITE_GLYPH_FIRST + 6] = {0.93426293f, 0.00595238f, 0.95418328f, 0.08928572f},  // '6'
+    [SPRITE_GLYPH_FIRST + 7] = {0.95617533f, 0.00595238f, 0.97609562f, 0.08928572f},  // '7'
+    [SPRITE_GLYPH_FIRST + 8] = {0.97808766f, 0.00595238f, 0.99800795f, 0.08928572f},  // '8'
+    [SPRITE_GLYPH_FIRST + 9] = {0.00199203f, 0.90476191f, 0.02191235f, 0.98809522f},  // '9'
+    [SPRITE_GLYPH_FIRST + 10] = {0.02390438f, 0.90476191f, 0.04382470f, 0.98809522f},  // ':'
+    [SPRITE_GLYPH_FIRST + 11] = {0.04581673f, 0.90476191f, 0.06573705f, 0.98809522f},  // 'C'
+    [SPRITE_GLYPH_FIRST + 12] = {0.06772909f, 0.90476191f, 0.08764941f, 0.98809522f},  // 'E'
+    [SPRITE_GLYPH_FIRST + 13] = {0.08964144f, 0.90476191f, 0.10956176f, 0.98809522f},  // 'I'
+    [SPRITE_GLYPH_FIRST + 14] = {0.11155379f, 0.90476191f, 0.13147411f, 0.98809522f},  // 'L'
+    [SPRITE_GLYPH_FIRST + 15] = {0.13346614f, 0.90476191f, 0.15338646f, 0.98809522f},  // 'O'
+    [SPRITE_GLYPH_FIRST + 16] = {0.15537849f, 0.90476191f, 0.17529881f, 0.98809522f},  // 'R'
+    [SPRITE_GLYPH_FIRST + 17] = {0.17729084f, 0.90476191f, 0.19721116f, 0.98809522f},  // 'S'
+    [SPRITE_GLYPH_FIRST + 18] = {0.19920319f, 0.90476191f, 0.21912351f, 0.98809522f},  // 'V'
+};
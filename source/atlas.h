@@ -0,0 +1,31 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+// Every sprite lives in misc/atlas.png, packed offline by tools/pack_atlas.c.
+// The game reads it from the asset bundle under this name
+#define ATLAS_ASSET "atlas"
+
+// Characters of the HUD font, glyph k is sprite SPRITE_GLYPH_FIRST + k
+#define GLYPH_CHARSET "0123456789:CEILORSV"
+#define GLYPH_COUNT ((int)sizeof(GLYPH_CHARSET) - 1)
+
+// Same order as the sprite list of tools/pack_atlas.c, then the glyphs
+typedef enum {
+    SPRITE_SHIP,
+    SPRITE_BULLET,
+    SPRITE_ASTEROID0,
+    SPRITE_ASTEROID1,
+    SPRITE_ASTEROID2,
+    SPRITE_GLYPH_FIRST,
+    SPRITE_COUNT = SPRITE_GLYPH_FIRST + GLYPH_COUNT
+} SpriteId;
+
+// Generated in atlas.c
+extern const int atlasWidth;
+extern const int atlasHeight;
+
+// u0, v0, u1, v1 of each sprite in the atlas
+extern const float atlasRects[SPRITE_COUNT][4];
+
+
+#endif
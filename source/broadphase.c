@@ -0,0 +1,122 @@
+/**
+ * Broadphase for the collisions.
+ * A cell is at least as wide as the largest possible sum of two radii, so
+ * anything touching an entity is in its cell or one of the 8 around it.
+ * The neighbourhood wraps around the edges like boundControl does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "broadphase.h"
+#include "entity.h"
+
+
+bool initGrid(Grid* g, float cellSize, int capacity) {
+  g->cellsPerSide = (int)(TOTAL_WIDTH / cellSize);
+  if (g->cellsPerSide < 1) {
+    g->cellsPerSide = 1;
+  }
+  g->cellSize = TOTAL_WIDTH / g->cellsPerSide;
+  g->capacity = capacity;
+
+  int cells = g->cellsPerSide * g->cellsPerSide;
+  g->cellStart = calloc(cells + 1, sizeof(int));
+  g->cellOf = malloc(sizeof(int) * capacity);
+  g->items = malloc(sizeof(int) * capacity);
+  g->itemX = malloc(sizeof(float) * capacity);
+  g->itemY = malloc(sizeof(float) * capacity);
+  g->itemRadius = malloc(sizeof(float) * capacity);
+
+  if (!g->cellStart || !g->cellOf || !g->items ||
+      !g->itemX || !g->itemY || !g->itemRadius) {
+    printf("ERROR: Out of memory when creating the collision grid\n");
+    freeGrid(g);
+    return false;
+  }
+  return true;
+}
+
+void freeGrid(Grid* g) {
+  free(g->cellStart);
+  free(g->cellOf);
+  free(g->items);
+  free(g->itemX);
+  free(g->itemY);
+  free(g->itemRadius);
+  g->cellStart = NULL;
+  g->cellOf = NULL;
+  g->items = NULL;
+  g->itemX = NULL;
+  g->itemY = NULL;
+  g->itemRadius = NULL;
+  g->capacity = 0;
+}
+
+static int cellCoord(const Grid* g, float v) {
+  int c = (int)((v + BOUNDARY_LIMIT) / g->cellSize);
+  if (c < 0) return 0;
+  if (c >= g->cellsPerSide) return g->cellsPerSide - 1;
+  return c;
+}
+
+void buildGrid(Grid* g, const EntityStore* s, int type) {
+  int cells = g->cellsPerSide * g->cellsPerSide;
+  memset(g->cellStart, 0, sizeof(int) * (cells + 1));
+
+  // 1) count the entities of each cell
+  for (int i = 0; i < s->count; i++) {
+    if (s->type[i] != type || s->lives[i] <= 0) {
+      g->cellOf[i] = -1;
+      continue;
+    }
+    int c = cellCoord(g, s->y[i]) * g->cellsPerSide + cellCoord(g, s->x[i]);
+    g->cellOf[i] = c;
+    g->cellStart[c]++;
+  }
+
+  // 2) running sum, cellStart[c] is now the end of cell c
+  for (int c = 1; c < cells; c++) {
+    g->cellStart[c] += g->cellStart[c - 1];
+  }
+  g->cellStart[cells] = g->cellStart[cells - 1];
+
+  // 3) scatter backwards, each cell ends up in dense order
+  //    and cellStart[c] back at the start of cell c
+  for (int i = s->count - 1; i >= 0; i--) {
+    int c = g->cellOf[i];
+    if (c >= 0) {
+      int k = --g->cellStart[c];
+      g->items[k] = i;
+      g->itemX[k] = s->x[i];
+      g->itemY[k] = s->y[i];
+      g->itemRadius[k] = s->radius[i];
+    }
+  }
+}
+
+int gridNeighbours(const Grid* g, float x, float y, int cells[9]) {
+  int n = g->cellsPerSide;
+  int cx = cellCoord(g, x);
+  int cy = cellCoord(g, y);
+
+  int count = 0;
+  for (int dy = -1; dy <= 1; dy++) {
+    int row = ((cy + dy) % n + n) % n;
+    for (int dx = -1; dx <= 1; dx++) {
+      int col = ((cx + dx) % n + n) % n;
+      int c = row * n + col;
+
+      // on tiny grids the wrap can visit a cell twice
+      bool seen = false;
+      for (int k = 0; k < count; k++) {
+        if (cells[k] == c) seen = true;
+      }
+      if (!seen) {
+        cells[count++] = c;
+      }
+    }
+  }
+  return count;
+}
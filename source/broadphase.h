@@ -0,0 +1,40 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <stdbool.h>
+#include "entity_store.h"
+
+// Uniform grid over the wrapped world [-BOUNDARY_LIMIT, BOUNDARY_LIMIT]^2.
+// Entities are bucketed by cell with a counting sort, so building it each
+// tick only touches the preallocated arrays.
+typedef struct {
+    int cellsPerSide;
+    float cellSize;
+
+    int* cellStart;         // cellsPerSide^2 + 1 offsets into items
+    int* cellOf;            // cell of each dense index, -1 when not inserted
+    int* items;             // dense indices sorted by cell
+
+    // position and radius of items[k], packed so the narrowphase streams
+    // through a cell with vector loads
+    float* itemX;
+    float* itemY;
+    float* itemRadius;
+
+    int capacity;
+} Grid;
+
+
+// cellSize is a minimum, it is stretched so the cells tile the world exactly
+bool initGrid(Grid* g, float cellSize, int capacity);
+void freeGrid(Grid* g);
+
+// Buckets every live entity of the given type
+void buildGrid(Grid* g, const EntityStore* s, int type);
+
+// Cell containing (x, y) and its 8 neighbours, wrapping across the edges.
+// Returns how many distinct cells were written to cells.
+int gridNeighbours(const Grid* g, float x, float y, int cells[9]);
+
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+// What the player can ask for, applied by the world at the start of a tick.
+// Stored on one byte in the input queue and in recordings, see replay.h
+typedef enum {
+    CMD_FORWARD,
+    CMD_TURN_LEFT,
+    CMD_TURN_RIGHT,
+    CMD_SHOOT,
+    CMD_COUNT
+} Command;
+
+
+#endif
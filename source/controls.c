@@ -2,9 +2,70 @@
 #include <stdlib.h>
 #include <emscripten.h>
 #include <emscripten/html5.h>
-#include <string.h>
 #include "controls.h"
 #include "input_queue.h"
+#include "profiler.h"
+
+// Key codes are the DOM keyCode values, uppercase ASCII for letters
+#define KEY_CODES 256
+#define NO_COMMAND 0xFF
+
+// Downloads the profile of the last frames, PROFILE builds only
+#define PROFILE_DUMP_KEY 'P'
+
+// When a binding fires: on every keydown (auto repeat included) or on release
+typedef enum {
+    ON_DOWN,
+    ON_UP,
+} KeyEdge;
+
+typedef struct {
+    unsigned keyCode;
+    KeyEdge edge;
+    Command command;
+} KeyBinding;
+
+// Every key the game reacts to
+static const KeyBinding bindings[] = {
+    {'W', ON_DOWN, CMD_FORWARD},
+    {'A', ON_DOWN, CMD_TURN_LEFT},
+    {'D', ON_DOWN, CMD_TURN_RIGHT},
+    {' ', ON_UP,   CMD_SHOOT},
+};
+
+// bindings as a direct lookup, keyCode -> command for each edge
+static uint8_t keyMap[2][KEY_CODES];
+
+
+static void buildKeyMap(void) {
+  for (int e = 0; e < 2; e++) {
+    for (int k = 0; k < KEY_CODES; k++) {
+      keyMap[e][k] = NO_COMMAND;
+    }
+  }
+
+  int count = sizeof(bindings) / sizeof(bindings[0]);
+  for (int b = 0; b < count; b++) {
+    keyMap[bindings[b].edge][bindings[b].keyCode] = bindings[b].command;
+  }
+}
+
+static void enqueueKey(InputQueue* q, KeyEdge edge, const EmscriptenKeyboardEvent* keyEvent) {
+  if (keyEvent->keyCode >= KEY_CODES) {
+    return;
+  }
+
+  uint8_t command = keyMap[edge][keyEvent->keyCode];
+  if (command == NO_COMMAND) {
+    return;
+  }
+
+  InputEvent ie;
+  ie.command = command;
+  ie.time = (float)keyEvent->timestamp;
+
+  enqueue(q, ie);
+}
 
 // Keyboard callback
 EM_BOOL onKeyDown(int eventType, const EmscriptenKeyboardEvent* keyEvent, void* userData) {
@@ -17,14 +78,7 @@ EM_BOOL onKeyDown(int eventType, const EmscriptenKeyboardEvent* keyEvent, void*
     return EM_FALSE;
   }
 
-
-    if (strcmp(keyEvent->key, " ") != 0) {
-        InputEvent ie;
-        ie.event_type = KEYBOARD;
-        ie.event_data.keyboard = *keyEvent;
-
-        enqueue(q, ie);
-    }
+  enqueueKey(q, ON_DOWN, keyEvent);
 
   return EM_FALSE;
 }
@@ -37,36 +91,20 @@ EM_BOOL onKeyUp(int eventType, const EmscriptenKeyboardEvent* keyEvent, void* us
       return EM_FALSE;
     }
 
-    if (strcmp(keyEvent->key, " ") == 0) {
-        InputEvent ie;
-        ie.event_type = KEYBOARD;
-        ie.event_data.keyboard = *keyEvent;
+    enqueueKey(q, ON_UP, keyEvent);
 
-        enqueue(q, ie);
+#ifdef PROFILE
+    if (keyEvent->keyCode == PROFILE_DUMP_KEY) {
+      PROFILE_DUMP(PROFILE_FILE);
     }
-    return EM_FALSE;
-}
-
-// Mouse callback
-EM_BOOL onMouseEvent(int eventType, const EmscriptenMouseEvent* mouseEvent, void* userData){
-
-  (void) eventType;
-
-  InputQueue* q = (InputQueue*) userData;
-  if (!q) {
-    return EM_FALSE; 
-  }
-
-  InputEvent ie;
-  ie.event_type = MOUSE;
-  ie.event_data.mouse = *mouseEvent;
-
-  enqueue(q, ie);
+#endif
 
-  return EM_FALSE;
+    return EM_FALSE;
 }
 
 void handleInput(InputQueue* user_input){
+  buildKeyMap();
+
   // Register keydown
   emscripten_set_keydown_callback(
     EMSCRIPTEN_EVENT_TARGET_WINDOW, // Where we watch for keyboard input
@@ -75,7 +113,7 @@ void handleInput(InputQueue* user_input){
     onKeyDown                       // callback function
   );
   
-  // Register keyup for space bar only
+  // Register keyup, only bindings on ON_UP react to it
   emscripten_set_keyup_callback(
     EMSCRIPTEN_EVENT_TARGET_WINDOW,
     user_input,
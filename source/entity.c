@@ -1,80 +1,13 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#include <GLES2/gl2.h>
 #include <math.h>
-#include <emscripten/html5.h>
-#include <sys/time.h> 
 
 #include "entity.h"
 #include "input_queue.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 
 
-
-// will help us get time in ms 
-long long timeInMilliseconds(void) {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  return (((long long)tv.tv_sec)*1000) + (tv.tv_usec / 1000);
-}
-
-
-
-GLuint loadTexturePNG(const char* filename) {
-  int width, height, channels;
-  unsigned char* data = stbi_load(filename, &width, &height, &channels, 4);
-  if (!data) {
-    printf("Failed to load PNG %s\n", filename);
-    return 0;
-  }
-
-  GLuint imageId;
-  glGenTextures(1, &imageId);
-  glBindTexture(GL_TEXTURE_2D, imageId);
-
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-               width, height, 0,
-               GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  stbi_image_free(data);
-
-  return imageId;
-}
-
-
-// allows us to create a vbo and ebo for each entity
-void initEntityGraphics(Entity* e) {
-  // 1) Generate and fill the VBO for this entity
-  glGenBuffers(1, &e->vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, e->vbo);
-  glBufferData(GL_ARRAY_BUFFER,
-               sizeof(GLfloat) * e->numVert,  // 4 floats per vertex
-               e->vertices,
-               GL_STATIC_DRAW);
-
-  // 2) Generate and fill the EBO
-  glGenBuffers(1, &e->ebo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e->ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               sizeof(GLushort) * e->numIndices,
-               e->indices,
-               GL_STATIC_DRAW);
-}
-
-void removeEntityGraphics(Entity* e) {
-  glDeleteBuffers(1, &e->vbo);
-  glDeleteBuffers(1, &e->ebo);
-  glDisableVertexAttribArray(0); 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-}
 /*
 ===================================================================
                  SHIP INITIALISATION
@@ -82,21 +15,6 @@ void removeEntityGraphics(Entity* e) {
 */ 
 
 
-// The ship will be lozenge shaped
-GLfloat verticesShip[] = {
-  // x',     y',      u,    v
-  -0.03f,  0.00f,  0.5f, 1.0f,   // Vertex 0: Rotated Top-center
-  0.00f,  0.03f,  1.0f, 0.5f,   // Vertex 1: Rotated Right-center
-  0.03f,  0.00f,  0.5f, 0.0f,   // Vertex 2: Rotated Bottom-center
-  0.00f, -0.03f,  0.0f, 0.5f    // Vertex 3: Rotated Left-center
-};
-
-GLushort indicesShip[] = {
-  0, 1, 2, // Triangle 1
-  0, 2, 3  // Triangle 2
-};
-
-
 void initPlayer(Entity* ship) {
   ship->x = 0.0f;
   ship->y = 0.0f;
@@ -104,18 +22,8 @@ void initPlayer(Entity* ship) {
   ship->vy = 0.001f;
   ship->angle = 0.0f;
   ship->lives = 3;
-  ship->time = timeInMilliseconds();
   ship->type = SHIP;
-  ship->textureId = loadTexturePNG("misc/ship.png");
-
-
-  ship->vertices = verticesShip;
-  ship->indices  = indicesShip;
-
-  ship->numVert   = sizeof(verticesShip)/sizeof(verticesShip[0]);
-  ship->numIndices = sizeof(indicesShip)/sizeof(indicesShip[0]);
-
-  initEntityGraphics(ship);
+  ship->sprite = SPRITE_SHIP;
 }
 
 
@@ -124,43 +32,18 @@ void initPlayer(Entity* ship) {
                  BULLET INITIALISATION
 ===================================================================
 */
-// 10x10
-const float rb = 0.005f;
-GLfloat verticesBullet[] = {
-  //  x,     y,     u,    v
-  -rb,  -rb,   0.0f, 0.0f,  // bottom-left
-  rb,  -rb,   1.0f, 0.0f,  // bottom-right
-  rb,   rb,   1.0f, 1.0f,  // top-right
-  -rb,   rb,   0.0f, 1.0f   // top-left
-};
-
-GLushort indicesBullet[] = {
-  0, 1, 2,
-  0, 2, 3
-};
-
-void initBullet(Entity* ship, Entity* bullet) {
+void initBullet(EntityStore* s, int ship, Entity* bullet) {
   bullet->type = BULLET;
-  bullet->x = ship->x;
-  bullet->y = ship->y;
-  bullet->angle = ship->angle;
-  bullet->time = timeInMilliseconds();
-  bullet->textureId = loadTexturePNG("misc/bullet.png");
-
-  // l'angle est mauvais pour 
-  bullet->vx = cosf(ship->angle) * BULLET_VELOCITY ;
-  bullet->vy = sinf(ship->angle) * BULLET_VELOCITY ;
-
-  bullet->vertices = verticesBullet;
-  //: This is the correct field for indices
-  bullet->indices  = indicesBullet;
-
+  bullet->x = s->x[ship];
+  bullet->y = s->y[ship];
+  bullet->angle = s->angle[ship];
+  bullet->sprite = SPRITE_BULLET;
   bullet->lives = 2;
 
-  bullet->numVert   = sizeof(verticesBullet)/sizeof(verticesBullet[0]);
-  bullet->numIndices = sizeof(indicesBullet)/sizeof(indicesBullet[0]);
+  // l'angle est mauvais pour 
+  bullet->vx = cosf(bullet->angle) * BULLET_VELOCITY ;
+  bullet->vy = sinf(bullet->angle) * BULLET_VELOCITY ;
 
-  initEntityGraphics(bullet);
 }
 
 
@@ -171,167 +54,95 @@ void initBullet(Entity* ship, Entity* bullet) {
 ===========================================================
 */
 
-// 300x300 pixels on 1000x1000 canvas
-const float r0 = 0.15f;
-GLfloat verticesAsteroid0[] = {
-  //  x,     y,     u,    v
-  -r0,  -r0,   0.0f, 0.0f,  // bottom-left
-  r0,  -r0,   1.0f, 0.0f,  // bottom-right
-  r0,   r0,   1.0f, 1.0f,  // top-right
-  -r0,   r0,   0.0f, 1.0f   // top-left
-};
-GLushort indicesAsteroid0[] = {
-  0, 1, 2,
-  0, 2, 3
-};
-
-
-const float r1 = 0.075f;
-GLfloat verticesAsteroid1[] = {
-  //  x,     y,     u,    v
-  -r1,  -r1,   0.0f, 0.0f,  // bottom-left
-  r1,  -r1,   1.0f, 0.0f,  // bottom-right
-  r1,   r1,   1.0f, 1.0f,  // top-right
-  -r1,   r1,   0.0f, 1.0f   // top-left
-};
-GLushort indicesAsteroid1[] = {
-  0, 1, 2,
-  0, 2, 3
-};
-
-
-// 75x75 pixels 
-const float r2 = 0.0375f;
-GLfloat verticesAsteroid2[] = {
-  //  x,     y,    u,    v
-  -r2,  -r2,   0.0f, 0.0f,   // bottom-left
-  r2,  -r2,   1.0f, 0.0f,   // bottom-right
-  r2,   r2,   1.0f, 1.0f,   // top-right
-  -r2,   r2,   0.0f, 1.0f    // top-left
-};
-GLushort indicesAsteroid2[] = {
-  0, 1, 2,
-  0, 2, 3
-};
-
-
-void initAsteroid0(Entity* asteroid) {
+void initAsteroid0(Rng* rng, Entity* asteroid) {
   // asteroids can spawn in a these points
   int spawnPoints[] = {-BOUNDARY_LIMIT + 1, BOUNDARY_LIMIT - 1 };
 
   asteroid->type = ASTEROID;
-  asteroid->textureId = loadTexturePNG("misc/asteroid0.png");
+  asteroid->sprite = SPRITE_ASTEROID0;
 
 
   // They can spawn anywhere along an edge
-  asteroid->x = spawnPoints[rand() % 2];  
-  asteroid->y = spawnPoints[rand() % 2];
-  asteroid->angle = ((double) rand() / (double) RAND_MAX) * 2.0 * M_PI;
-  asteroid->time = timeInMilliseconds();
+  asteroid->x = spawnPoints[rngBelow(rng, 2)];  
+  asteroid->y = spawnPoints[rngBelow(rng, 2)];
+  asteroid->angle = rngFloat(rng) * 2.0 * M_PI;
 
   asteroid->lives = 3;
 
   asteroid->vx = cosf(asteroid->angle) * ASTEROID_VELOCITY ;
   asteroid->vy = sinf(asteroid->angle) * ASTEROID_VELOCITY ;
 
-  asteroid->vertices = verticesAsteroid0;
-  asteroid->indices  = indicesAsteroid0;
-
-  asteroid->numVert   = sizeof(verticesAsteroid0)/sizeof(verticesAsteroid0[0]);
-  asteroid->numIndices = sizeof(indicesAsteroid0)/sizeof(indicesAsteroid0[0]);
-
-  initEntityGraphics(asteroid);
 }
 
-void initAsteroid1(Entity* asteroid) {
+void initAsteroid1(Rng* rng, Entity* asteroid) {
   // asteroids can spawn in a these points
   int spawnPoints[] = {-BOUNDARY_LIMIT + 1, BOUNDARY_LIMIT - 1 };
 
   asteroid->type = ASTEROID;
-  asteroid->textureId = loadTexturePNG("misc/asteroid1.png");
+  asteroid->sprite = SPRITE_ASTEROID1;
 
   // They can spawn anywhere along an edge
-  asteroid->x = spawnPoints[rand() % 2];  
-  asteroid->y = spawnPoints[rand() % 2];
-  asteroid->angle = ((double) rand() / (double) RAND_MAX) * 2.0 * M_PI;
-  asteroid->time = timeInMilliseconds();
+  asteroid->x = spawnPoints[rngBelow(rng, 2)];  
+  asteroid->y = spawnPoints[rngBelow(rng, 2)];
+  asteroid->angle = rngFloat(rng) * 2.0 * M_PI;
 
   asteroid->lives = 2;
 
   asteroid->vx = cosf(asteroid->angle) * ASTEROID_VELOCITY ;
   asteroid->vy = sinf(asteroid->angle) * ASTEROID_VELOCITY ;
 
-  asteroid->vertices = verticesAsteroid1;
-  asteroid->indices  = indicesAsteroid1;
-
-  asteroid->numVert   = sizeof(verticesAsteroid1)/sizeof(verticesAsteroid1[0]);
-  asteroid->numIndices = sizeof(indicesAsteroid1)/sizeof(indicesAsteroid1[0]);
-
-  initEntityGraphics(asteroid);
 }
 
-void initAsteroid2(Entity* asteroid) {
+void initAsteroid2(Rng* rng, Entity* asteroid) {
   // asteroids can spawn in a these points
   int spawnPoints[] = {-BOUNDARY_LIMIT + 1, BOUNDARY_LIMIT - 1 };
 
   asteroid->type = ASTEROID;
-  asteroid->textureId = loadTexturePNG("misc/asteroid2.png");
+  asteroid->sprite = SPRITE_ASTEROID2;
 
 
   // They can spawn anywhere along an edge
-  asteroid->x = spawnPoints[rand() % 2];  
-  asteroid->y = spawnPoints[rand() % 2];
-  asteroid->angle = ((double) rand() / (double) RAND_MAX) * 2.0 * M_PI;
-  asteroid->time = timeInMilliseconds();
+  asteroid->x = spawnPoints[rngBelow(rng, 2)];  
+  asteroid->y = spawnPoints[rngBelow(rng, 2)];
+  asteroid->angle = rngFloat(rng) * 2.0 * M_PI;
 
   asteroid->lives = 1;
 
   asteroid->vx = cosf(asteroid->angle) * ASTEROID_VELOCITY ;
   asteroid->vy = sinf(asteroid->angle) * ASTEROID_VELOCITY ;
 
-  asteroid->vertices = verticesAsteroid2;
-  asteroid->indices  = indicesAsteroid2;
-
-
-  asteroid->numVert   = sizeof(verticesAsteroid2)/sizeof(verticesAsteroid2[0]);
-  asteroid->numIndices = sizeof(indicesAsteroid2)/sizeof(indicesAsteroid2[0]);
-
-
-  initEntityGraphics(asteroid);
 }
 
 
 
-void splitAsteroid(Entity* father, Entity* son1, Entity* son2) {
-  if (father->lives <= 1) {
-    son1 = NULL;
-    son2 = NULL;
+void splitAsteroid(Rng* rng, EntityStore* s, int father, Entity* son1, Entity* son2) {
+  if (s->lives[father] <= 1) {
     return;
   }
 
 
-  if (father->lives == 3) {
-    initAsteroid1(son1);
-    initAsteroid1(son2);
+  if (s->lives[father] == 3) {
+    initAsteroid1(rng, son1);
+    initAsteroid1(rng, son2);
   } 
-  else if (father->lives == 2) {
-    initAsteroid2(son1);
-    initAsteroid2(son2);
+  else if (s->lives[father] == 2) {
+    initAsteroid2(rng, son1);
+    initAsteroid2(rng, son2);
   }
   // Copy position from the father so they spawn at the same spot.
-  son1->x = father->x;
-  son1->y = father->y;
-  son2->x = father->x;
-  son2->y = father->y;
+  son1->x = s->x[father];
+  son1->y = s->y[father];
+  son2->x = s->x[father];
+  son2->y = s->y[father];
 
 
 
   float possibleAngles[3] = {25.0f, 45.0f, 65.0f};
-  float chosenDeg = possibleAngles[rand() % 3];  
+  float chosenDeg = possibleAngles[rngBelow(rng, 3)];  
   float offsetRad = chosenDeg * (M_PI / 180.0f);
 
-  son1->angle = father->angle + offsetRad;
-  son2->angle = father->angle - offsetRad;
+  son1->angle = s->angle[father] + offsetRad;
+  son2->angle = s->angle[father] - offsetRad;
 
   float speedFactor = 1.1f; 
   son1->vx = cosf(son1->angle) * speedFactor * ASTEROID_VELOCITY;
@@ -351,88 +162,99 @@ void splitAsteroid(Entity* father, Entity* son1, Entity* son2) {
 */
 
 
-void updatePosition(Entity* e, float dragLoss) {
-  long long currentTime = timeInMilliseconds();
-  float delta_t = (float)(currentTime - e->time) / 1000.0f; // Convert ms to seconds
-  e->time = currentTime;
+// dt is the tick length in seconds, velocities are in units per reference tick
+// and dragLoss is lost once per reference tick, so the motion does not depend
+// on the tick rate
+void updatePosition(EntityStore* s, int i, float dragLoss, float dt) {
+  float ticks = dt * REFERENCE_TICK_RATE;
 
   // Update velocity based on acceleration
-  e->vx += e->ax * delta_t;
-  e->vy += e->ay * delta_t;
+  s->vx[i] += s->ax[i] * dt;
+  s->vy[i] += s->ay[i] * dt;
 
-  float speed = sqrtf(e->vx * e->vx + e->vy * e->vy);
-  if (speed > MAX_VELOCITY && e->type == 0) {
-    e->vx = (e->vx / speed) * MAX_VELOCITY;
-    e->vy = (e->vy / speed) * MAX_VELOCITY;
+  float speed = sqrtf(s->vx[i] * s->vx[i] + s->vy[i] * s->vy[i]);
+  if (speed > MAX_VELOCITY && s->type[i] == SHIP) {
+    s->vx[i] = (s->vx[i] / speed) * MAX_VELOCITY;
+    s->vy[i] = (s->vy[i] / speed) * MAX_VELOCITY;
   }
 
   // Update position based on velocity
-  e->x += e->vx;
-  e->y += e->vy;
+  s->x[i] += s->vx[i] * ticks;
+  s->y[i] += s->vy[i] * ticks;
 
-  boundControl(e);
+  boundControl(s, i);
 
   // Apply a friction factor
-  e->vx *= 1 - dragLoss;
-  e->vy *= 1 - dragLoss;
+  if (dragLoss > 0.0f) {
+    float keep = powf(1 - dragLoss, ticks);
+    s->vx[i] *= keep;
+    s->vy[i] *= keep;
+  }
 
   // Reset acceleration for the next frame
-  e->ax = 0.0f;
-  e->ay = 0.0f;
+  s->ax[i] = 0.0f;
+  s->ay[i] = 0.0f;
 }
 
-void boundControl(Entity* e) {
+void boundControl(EntityStore* s, int i) {
 
   // if its a bullet we will want it to despawn
   bool boundHit = false;
 
   // Wrap X position
-  if (e->x > BOUNDARY_LIMIT) {
-    e->x -= TOTAL_WIDTH;
+  if (s->x[i] > BOUNDARY_LIMIT) {
+    s->x[i] -= TOTAL_WIDTH;
     boundHit = true;
-  } else if (e->x < -BOUNDARY_LIMIT) {
-    e->x += TOTAL_WIDTH;
+  } else if (s->x[i] < -BOUNDARY_LIMIT) {
+    s->x[i] += TOTAL_WIDTH;
     boundHit = true;
 
   }
 
   // Wrap Y position
-  if (e->y > BOUNDARY_LIMIT) {
-    e->y -= TOTAL_WIDTH;
+  if (s->y[i] > BOUNDARY_LIMIT) {
+    s->y[i] -= TOTAL_WIDTH;
     boundHit = true;
-  } else if (e->y < -BOUNDARY_LIMIT) {
-    e->y += TOTAL_WIDTH;
+  } else if (s->y[i] < -BOUNDARY_LIMIT) {
+    s->y[i] += TOTAL_WIDTH;
     boundHit = true;
   }
 
-  if(boundHit == true && e->type == 1){
-    e->lives--;
+  if(boundHit == true && s->type[i] == BULLET){
+    s->lives[i]--;
   }
 }
 
 
-float boundingRadius(Entity* e) {
-  switch (e->type) {
+float radiusOf(int type, int lives) {
+  switch (type) {
     case SHIP:
-      return (0.03f/2.0f) * BOUNDARY_LIMIT;
+      return (SHIP_HALF_SIZE/2.0f) * BOUNDARY_LIMIT;
     case BULLET:
-      return rb*1000;
+      return BULLET_HALF_SIZE*1000;
     case ASTEROID:
-      if (e->lives == 3) return r0 * BOUNDARY_LIMIT * 0.7;  
-      if (e->lives == 2) return r1 * BOUNDARY_LIMIT * 0.8;
-      if (e->lives == 1) return r2 * BOUNDARY_LIMIT * 0.8;
+      if (lives == 3) return ASTEROID0_HALF_SIZE * BOUNDARY_LIMIT * 0.7;  
+      if (lives == 2) return ASTEROID1_HALF_SIZE * BOUNDARY_LIMIT * 0.8;
+      if (lives == 1) return ASTEROID2_HALF_SIZE * BOUNDARY_LIMIT * 0.8;
   }
   return 0.05f * BOUNDARY_LIMIT;
 }
 
-bool checkCollision( Entity* a, Entity* b) {
-  float dx = a->x - b->x;
-  float dy = a->y - b->y;
+float wrapDelta(float d) {
+  if (d > BOUNDARY_LIMIT) {
+    d -= TOTAL_WIDTH;
+  } else if (d < -BOUNDARY_LIMIT) {
+    d += TOTAL_WIDTH;
+  }
+  return d;
+}
+
+bool checkCollision(EntityStore* s, int a, int b) {
+  float dx = wrapDelta(s->x[a] - s->x[b]);
+  float dy = wrapDelta(s->y[a] - s->y[b]);
   float dist2 = dx * dx + dy * dy;
 
-  float ra = boundingRadius(a);
-  float rb = boundingRadius(b);
-  float r = ra + rb;
+  float r = s->radius[a] + s->radius[b];
 
   return (dist2 <= (r * r));
 }
@@ -443,57 +265,51 @@ bool checkCollision( Entity* a, Entity* b) {
    INPUT ACTIONS
 ==========================================================
 */
-void moveForward(Entity* e) {
-  e->ax += cosf(e->angle) * ACCELERATION;
-  e->ay += sinf(e->angle) * ACCELERATION;
+void moveForward(EntityStore* s, int i) {
+  s->ax[i] += cosf(s->angle[i]) * ACCELERATION;
+  s->ay[i] += sinf(s->angle[i]) * ACCELERATION;
 }
 
-void turnLeft(Entity* e) {
-  e->angle += TURN_RATE;
+void turnLeft(EntityStore* s, int i) {
+  s->angle[i] += TURN_RATE;
 }
 
-void turnRight(Entity* e) {
-  e->angle -= TURN_RATE;
+void turnRight(EntityStore* s, int i) {
+  s->angle[i] -= TURN_RATE;
 }
 
-void shoot(Entity* e) {
-  e->shoot = true;
+void shoot(EntityStore* s, int i) {
+  s->shoot[i] = true;
 }
 
-void updateEntityTime(Entity* e) {
-  e->time = timeInMilliseconds();
+void statePrint(EntityStore* s, int i) {
+  printf("POSITION   x=%f y=%f angle=%f\n", s->x[i], s->y[i], s->angle[i]);
+  printf("ACCEL      ax=%f ay=%f\n", s->ax[i], s->ay[i]);
+  printf("SPEED      vx=%f vy=%f\n", s->vx[i], s->vy[i]);
 }
 
-void statePrint(Entity* e) {
-  printf("POSITION   x=%f y=%f angle=%f\n", e->x, e->y, e->angle);
-  printf("ACCEL      ax=%f ay=%f\n", e->ax, e->ay);
-  printf("SPEED      vx=%f vy=%f\n", e->vx, e->vy);
+
+void applyCommand(EntityStore* s, int ship, Command command) {
+  switch (command) {
+    case CMD_FORWARD:    moveForward(s, ship); break;
+    case CMD_TURN_LEFT:  turnLeft(s, ship);    break;
+    case CMD_TURN_RIGHT: turnRight(s, ship);   break;
+    case CMD_SHOOT:      shoot(s, ship);       break;
+    default: break;
+  }
 }
 
+int registerInputs(InputQueue* inputQueue, Command* commands, int maxCommands) {
+  InputEvent events[QUEUE_CAP];
+  if (maxCommands > QUEUE_CAP) {
+    maxCommands = QUEUE_CAP;
+  }
 
-void registerInputs(InputQueue* inputQueue, Entity* e) {
-  // We'll read up to MOVE_PER_CALL events
-  for (int j = 0; j < MOVE_PER_CALL; j++) {
-    // If no event is left, break early
-    if (isEmpty(inputQueue)) {
-      break;
-    }
-
-    InputEvent input = pop(inputQueue);
-
-    if (input.event_type == KEYBOARD) {
-      char* key = input.event_data.keyboard.key;
-      if (strcmp(key, "w") == 0) {
-        moveForward(e);
-      } else if (strcmp(key, "d") == 0) {
-        turnRight(e);
-      } else if (strcmp(key, "a") == 0) {
-        turnLeft(e);
-      } else if (strcmp(key, " ") == 0){
-        shoot(e);
-      }
-
-    }
+  // the bindings already turned the keys into commands
+  int count = drainQueue(inputQueue, events, maxCommands);
+  for (int i = 0; i < count; i++) {
+    commands[i] = (Command)events[i].command;
   }
 
+  return count;
 }
@@ -4,9 +4,11 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <math.h>
-#include <GLES2/gl2.h>
 #include "input_queue.h"
-#include "entity.h"
+#include "command.h"
+#include "entity_store.h"
+#include "atlas.h"
+#include "rng.h"
 
 
 #define BOUNDARY_LIMIT 1000.0f
@@ -21,18 +23,31 @@
 #define ACCELERATION 3
 #define MAX_VELOCITY 5 
 #define DRAG 50 
+// Share of the ship velocity lost every reference tick
+#define SHIP_DRAG_LOSS 0.005f
 #define BULLET_VELOCITY 8
 #define ASTEROID_VELOCITY 2 
 
+// Velocities are expressed in units per tick of a 60 Hz simulation
+#define REFERENCE_TICK_RATE 60.0f
+
+// Half size of the sprites in normalised coordinates
+#define SHIP_HALF_SIZE 0.03f
+#define BULLET_HALF_SIZE 0.005f
+#define ASTEROID0_HALF_SIZE 0.15f
+#define ASTEROID1_HALF_SIZE 0.075f
+#define ASTEROID2_HALF_SIZE 0.0375f
+
 #define SHIP 0
 #define BULLET 1
 #define ASTEROID 2
 
-// entites have 6 degree of freedom
+// Description of a new entity, filled by the init functions and
+// copied into the EntityStore by addEntity
 typedef struct entity{
 
   int type;
-  GLuint textureId;
+  SpriteId sprite;
 
   float x;
   float y;
@@ -40,70 +55,55 @@ typedef struct entity{
   float vx;
   float vy;
 
-  float ax;
-  float ay;
-
-  float mass;
-  float drag;
-
   float angle;
 
   int lives;
 
-  bool shoot;
-  
-  long time; 
-
-  // we will only handle vertices for now
-  // needs to be allocated dynamically to handle all possible entities
-  GLfloat* vertices;
-  int numVert;
-
-  // we also will need to add an array of indices to actually draw the triangle
-  GLushort* indices;
-  int numIndices;
- 
-  GLuint ebo;
-  GLuint vbo;
 }Entity;
 
 
-long long timeInMilliseconds(void); 
-
+void initPlayer(Entity* e);
 
-void removeEntityGraphics(Entity* e);
+void initBullet(EntityStore* s, int ship, Entity* bullet);
 
+void initAsteroid0(Rng* rng, Entity* asteroid);
 
-void initPlayer(Entity* e);
+void initAsteroid1(Rng* rng, Entity* asteroid);
 
-void initBullet(Entity* ship, Entity* bullet);
+void initAsteroid2(Rng* rng, Entity* asteroid);
 
-void initAsteroid0(Entity* asteroid);
+void splitAsteroid(Rng* rng, EntityStore* s, int father, Entity* son1, Entity* son2);
 
-void initAsteroid1(Entity* asteroid);
+void boundControl(EntityStore* s, int i);
 
-void initAsteroid2(Entity* asteroid);
+// Collision radius, addEntity stores it in the radius array
+float radiusOf(int type, int lives);
 
-void splitAsteroid(Entity* father, Entity* son1, Entity* son2);
+// Shortest difference between two coordinates on the wrapped world
+float wrapDelta(float d);
 
-void boundControl(Entity* e);
+// Circle test, distances are measured across the wrapped edges. Scalar
+// reference of collideCircles
+bool checkCollision(EntityStore* s, int a, int b);
 
-bool checkCollision( Entity* a, Entity* b);
+void moveForward(EntityStore* s, int i);
 
-void moveForward(Entity* e);
+void turnLeft(EntityStore* s, int i);
 
-void turnLeft(Entity* e);
+void turnRight(EntityStore* s, int i);
 
-void turnRight(Entity* e);
+void shoot(EntityStore* s, int i);
 
-void shoot(Entity* e);
+void statePrint(EntityStore* s, int i);
 
-void statePrint(Entity* e);
+void applyCommand(EntityStore* s, int ship, Command command);
 
-void registerInputs(InputQueue* i, Entity* e);
+// Pops up to maxCommands queued commands, returns how many
+int registerInputs(InputQueue* i, Command* commands, int maxCommands);
 
 
-void updatePosition(Entity* e, float dragLoss);
+// One entity, the reference the motion kernel is checked against
+void updatePosition(EntityStore* s, int i, float dragLoss, float dt);
 
 
 #endif
@@ -0,0 +1,215 @@
+/**
+ * Dense structure-of-arrays storage for the entities.
+ * Handles go through a sparse slot table so they stay valid while entities
+ * are moved around by swap-removal, and a generation counter per slot makes
+ * a handle to a removed entity resolve to -1 instead of to its successor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "entity_store.h"
+
+
+bool initEntityStore(EntityStore* s, int capacity) {
+  // the store may be uninitialised stack memory, freeEntityStore on a
+  // partial failure must only see NULLs where nothing was allocated
+  memset(s, 0, sizeof(EntityStore));
+  s->count = 0;
+  s->capacity = capacity;
+
+  s->x = malloc(sizeof(float) * capacity);
+  s->y = malloc(sizeof(float) * capacity);
+  s->vx = malloc(sizeof(float) * capacity);
+  s->vy = malloc(sizeof(float) * capacity);
+  s->ax = malloc(sizeof(float) * capacity);
+  s->ay = malloc(sizeof(float) * capacity);
+  s->angle = malloc(sizeof(float) * capacity);
+  s->radius = malloc(sizeof(float) * capacity);
+  s->prevX = malloc(sizeof(float) * capacity);
+  s->prevY = malloc(sizeof(float) * capacity);
+  s->prevAngle = malloc(sizeof(float) * capacity);
+  s->type = malloc(sizeof(int) * capacity);
+  s->lives = malloc(sizeof(int) * capacity);
+  s->shoot = malloc(sizeof(bool) * capacity);
+  s->sprite = malloc(sizeof(SpriteId) * capacity);
+  s->handle = malloc(sizeof(EntityHandle) * capacity);
+
+  if (!s->x || !s->y || !s->vx || !s->vy || !s->ax || !s->ay || !s->angle ||
+      !s->radius || !s->prevX || !s->prevY || !s->prevAngle ||
+      !s->type || !s->lives || !s->shoot || !s->sprite ||
+      !s->handle ||
+      !initPool(&s->slots, sizeof(EntitySlot), capacity)) {
+    printf("ERROR: Out of memory when creating the entity store\n");
+    freeEntityStore(s);
+    return false;
+  }
+
+  // generation 0 is reserved for INVALID_HANDLE
+  EntitySlot* table = (EntitySlot*)s->slots.items;
+  for (int i = 0; i < capacity; i++) {
+    table[i].dense = -1;
+    table[i].generation = 1;
+  }
+
+  return true;
+}
+
+void freeEntityStore(EntityStore* s) {
+  free(s->x);
+  free(s->y);
+  free(s->vx);
+  free(s->vy);
+  free(s->ax);
+  free(s->ay);
+  free(s->angle);
+  free(s->radius);
+  free(s->prevX);
+  free(s->prevY);
+  free(s->prevAngle);
+  free(s->type);
+  free(s->lives);
+  free(s->shoot);
+  free(s->sprite);
+  free(s->handle);
+  freePool(&s->slots);
+
+  memset(s, 0, sizeof(EntityStore));
+}
+
+int storeCreate(EntityStore* s, EntityHandle* handle) {
+  EntitySlot* slot = poolAcquire(&s->slots);
+  if (!slot) {
+    *handle = INVALID_HANDLE;
+    return -1;
+  }
+
+  int i = s->count++;
+  slot->dense = i;
+
+  handle->slot = (uint32_t)(slot - (EntitySlot*)s->slots.items);
+  handle->generation = slot->generation;
+  s->handle[i] = *handle;
+
+  s->x[i] = 0.0f;
+  s->y[i] = 0.0f;
+  s->vx[i] = 0.0f;
+  s->vy[i] = 0.0f;
+  s->ax[i] = 0.0f;
+  s->ay[i] = 0.0f;
+  s->angle[i] = 0.0f;
+  s->radius[i] = 0.0f;
+  s->prevX[i] = 0.0f;
+  s->prevY[i] = 0.0f;
+  s->prevAngle[i] = 0.0f;
+  s->type[i] = 0;
+  s->lives[i] = 0;
+  s->shoot[i] = false;
+  s->sprite[i] = SPRITE_SHIP;
+
+  return i;
+}
+
+// Gives the slot of dense index i back, every handle to it goes stale
+static void releaseSlot(EntityStore* s, int i) {
+  EntitySlot* table = (EntitySlot*)s->slots.items;
+  EntitySlot* removed = &table[s->handle[i].slot];
+
+  removed->generation++;
+  if (removed->generation == 0) {
+    removed->generation = 1;
+  }
+  removed->dense = -1;
+  poolRelease(&s->slots, removed);
+}
+
+// Moves the entities [from, from + n) down to [to, to + n), to < from
+static void moveEntities(EntityStore* s, int to, int from, int n) {
+  memmove(&s->x[to], &s->x[from], sizeof(float) * n);
+  memmove(&s->y[to], &s->y[from], sizeof(float) * n);
+  memmove(&s->vx[to], &s->vx[from], sizeof(float) * n);
+  memmove(&s->vy[to], &s->vy[from], sizeof(float) * n);
+  memmove(&s->ax[to], &s->ax[from], sizeof(float) * n);
+  memmove(&s->ay[to], &s->ay[from], sizeof(float) * n);
+  memmove(&s->angle[to], &s->angle[from], sizeof(float) * n);
+  memmove(&s->radius[to], &s->radius[from], sizeof(float) * n);
+  memmove(&s->prevX[to], &s->prevX[from], sizeof(float) * n);
+  memmove(&s->prevY[to], &s->prevY[from], sizeof(float) * n);
+  memmove(&s->prevAngle[to], &s->prevAngle[from], sizeof(float) * n);
+  memmove(&s->type[to], &s->type[from], sizeof(int) * n);
+  memmove(&s->lives[to], &s->lives[from], sizeof(int) * n);
+  memmove(&s->shoot[to], &s->shoot[from], sizeof(bool) * n);
+  memmove(&s->sprite[to], &s->sprite[from], sizeof(SpriteId) * n);
+  memmove(&s->handle[to], &s->handle[from], sizeof(EntityHandle) * n);
+
+  EntitySlot* table = (EntitySlot*)s->slots.items;
+  for (int i = to; i < to + n; i++) {
+    table[s->handle[i].slot].dense = i;
+  }
+}
+
+void storeRemove(EntityStore* s, int i) {
+  if (i < 0 || i >= s->count) return;
+
+  EntitySlot* table = (EntitySlot*)s->slots.items;
+  releaseSlot(s, i);
+
+  int last = --s->count;
+  if (i != last) {
+    s->x[i] = s->x[last];
+    s->y[i] = s->y[last];
+    s->vx[i] = s->vx[last];
+    s->vy[i] = s->vy[last];
+    s->ax[i] = s->ax[last];
+    s->ay[i] = s->ay[last];
+    s->angle[i] = s->angle[last];
+    s->radius[i] = s->radius[last];
+    s->prevX[i] = s->prevX[last];
+    s->prevY[i] = s->prevY[last];
+    s->prevAngle[i] = s->prevAngle[last];
+    s->type[i] = s->type[last];
+    s->lives[i] = s->lives[last];
+    s->shoot[i] = s->shoot[last];
+    s->sprite[i] = s->sprite[last];
+    s->handle[i] = s->handle[last];
+
+    table[s->handle[i].slot].dense = i;
+  }
+}
+
+void storeRemoveSorted(EntityStore* s, const int* dead, int n) {
+  if (n <= 0) return;
+
+  for (int k = 0; k < n; k++) {
+    releaseSlot(s, dead[k]);
+  }
+
+  // the run of survivors after dead[k] moves down by k + 1,
+  // nothing before dead[0] moves
+  for (int k = 0; k < n; k++) {
+    int start = dead[k] + 1;
+    int end = k + 1 < n ? dead[k + 1] : s->count;
+    if (end > start) {
+      moveEntities(s, start - (k + 1), start, end - start);
+    }
+  }
+  s->count -= n;
+}
+
+void storeSavePrevious(EntityStore* s) {
+  memcpy(s->prevX, s->x, sizeof(float) * s->count);
+  memcpy(s->prevY, s->y, sizeof(float) * s->count);
+  memcpy(s->prevAngle, s->angle, sizeof(float) * s->count);
+}
+
+int storeIndex(const EntityStore* s, EntityHandle h) {
+  if (h.generation == 0 || h.slot >= (uint32_t)s->capacity) {
+    return -1;
+  }
+
+  const EntitySlot* slot = &((const EntitySlot*)s->slots.items)[h.slot];
+  if (slot->generation != h.generation) {
+    return -1;
+  }
+  return slot->dense;
+}
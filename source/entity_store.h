@@ -0,0 +1,77 @@
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pool.h"
+#include "atlas.h"
+
+
+// Safe reference to an entity, it goes stale as soon as the entity is removed.
+// generation is never 0 for a live entity so a zeroed handle is always invalid.
+typedef struct {
+    uint32_t slot;
+    uint32_t generation;
+} EntityHandle;
+
+#define INVALID_HANDLE ((EntityHandle){0, 0})
+
+// Entry of the sparse table, pointed to by a handle
+typedef struct {
+    int dense;              // index in the parallel arrays
+    uint32_t generation;
+} EntitySlot;
+
+// Structure of arrays: the live entities are packed in [0, count)
+// of every array, removal moves the last entity into the hole or, for a
+// batch, slides the survivors down.
+typedef struct {
+    int count;
+    int capacity;
+
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* ax;
+    float* ay;
+    float* angle;
+    float* radius;          // collision radius, set when the entity is added
+
+    // state at the previous tick, render interpolates towards the current one
+    float* prevX;
+    float* prevY;
+    float* prevAngle;
+
+    int* type;
+    int* lives;
+    bool* shoot;
+
+    SpriteId* sprite;       // image in the atlas
+
+    EntityHandle* handle;   // dense index -> handle of the entity
+    Pool slots;             // sparse table of EntitySlot
+} EntityStore;
+
+
+bool initEntityStore(EntityStore* s, int capacity);
+void freeEntityStore(EntityStore* s);
+
+// Appends a zeroed entity, returns its dense index or -1 if the store is full
+int storeCreate(EntityStore* s, EntityHandle* handle);
+
+// Swap-remove, the entity at count - 1 takes index i
+void storeRemove(EntityStore* s, int i);
+
+// Removes the n entities at the dense indices dead, sorted ascending and
+// distinct. The survivors are packed down in one pass with their order kept
+void storeRemoveSorted(EntityStore* s, const int* dead, int n);
+
+// Copies the current position and angle of every entity into prev
+void storeSavePrevious(EntityStore* s);
+
+// Dense index of a handle, -1 if the entity does not exist anymore
+int storeIndex(const EntityStore* s, EntityHandle h);
+
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * Per-frame clock.
+ * The time source is read once per frame from the platform layer:
+ * performance.now in the browser, a simulated clock in the headless build.
+ */
+
+#include "frame_clock.h"
+#include "platform.h"
+
+
+double monotonicSeconds(void) {
+  return platformNow();
+}
+
+void initFrameClock(FrameClock* c) {
+  c->start = monotonicSeconds();
+  c->now = c->start;
+  c->dt = 0.0f;
+}
+
+void tickFrameClock(FrameClock* c) {
+  double now = monotonicSeconds();
+  float dt = (float)(now - c->now);
+
+  if (dt < 0.0f) dt = 0.0f;
+  if (dt > MAX_FRAME_DT) dt = MAX_FRAME_DT;
+
+  c->now = now;
+  c->dt = dt;
+}
@@ -0,0 +1,25 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+// Longest step handed to the simulation, a tab coming back from the
+// background should not throw the ship across the world
+#define MAX_FRAME_DT 0.25f
+
+// Sampled once per frame, every update of that frame sees the same dt
+typedef struct {
+    double start;   // seconds, when the clock was created
+    double now;     // seconds, sample of the current frame
+    float dt;       // seconds since the previous frame
+} FrameClock;
+
+
+// High resolution monotonic time in seconds
+double monotonicSeconds(void);
+
+void initFrameClock(FrameClock* c);
+
+// Takes the sample for a new frame and updates dt
+void tickFrameClock(FrameClock* c);
+
+
+#endif
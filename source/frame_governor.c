@@ -0,0 +1,110 @@
+/**
+ * Dynamic resolution governor.
+ * Only plain arithmetic on frame times, the renderer applies the level.
+ * GL calls return once queued, a GPU that falls behind shows up as calls
+ * that block (orphaned buffers, the blits to the canvas) inside the work.
+ * A level up is a probe that gets undone if the work stops fitting again.
+ */
+
+#include <stdio.h>
+
+#include "frame_governor.h"
+
+
+// From the full resolution with 4x MSAA down to half the resolution
+static const ResolutionLevel levels[] = {
+    {1.0f, 4},
+    {1.0f, 2},
+    {1.0f, 0},
+    {0.85f, 0},
+    {0.7f, 0},
+    {0.6f, 0},
+    {0.5f, 0},
+};
+#define LEVEL_COUNT (int)(sizeof(levels) / sizeof(levels[0]))
+
+// Weight of a new frame in the average
+#define SMOOTHING 0.1f
+
+// Too slow: the work takes over target * SLOW_FACTOR, the rest of the frame
+// belongs to the simulation and the browser. Room to spare: under
+// target * FAST_FACTOR, enough for the pixels of the level above
+#define SLOW_FACTOR 0.8f
+#define FAST_FACTOR 0.5f
+
+// Frames to wait after a change before judging the level, the average
+// needs them to forget the previous one
+#define SETTLE_FRAMES 30
+
+// Frames on time before a raise, doubled after every failed one
+#define MIN_RAISE_DELAY 120
+#define MAX_RAISE_DELAY 1920
+
+// Longer work is a hitch (GC, a shader compiled late), not a trend
+#define MAX_FRAME_TIME 0.25f
+
+
+void initFrameGovernor(FrameGovernor* g, float targetFrameTime, int maxSamples) {
+  g->targetFrameTime = targetFrameTime;
+  g->maxSamples = maxSamples;
+  g->average = targetFrameTime * FAST_FACTOR;
+  g->level = 0;
+  g->bestLevel = 0;
+  g->framesAtLevel = 0;
+  g->raiseDelay = MIN_RAISE_DELAY;
+  g->raised = false;
+}
+
+static void setLevel(FrameGovernor* g, int level) {
+  g->raised = level < g->level;
+  g->level = level;
+  g->framesAtLevel = 0;
+  printf("governor   level %d   scale %.2f   msaa %d\n",
+         level, levels[level].scale, governorLevel(g).samples);
+}
+
+bool governFrame(FrameGovernor* g, float workTime) {
+  if (workTime <= 0.0f || workTime > MAX_FRAME_TIME) {
+    return false;
+  }
+
+  g->average += (workTime - g->average) * SMOOTHING;
+  g->framesAtLevel++;
+  if (g->framesAtLevel < SETTLE_FRAMES) {
+    return false;
+  }
+
+  if (g->average > g->targetFrameTime * SLOW_FACTOR && g->level + 1 < LEVEL_COUNT) {
+    // the last raise did not hold, wait longer before the next one
+    if (g->raised && g->framesAtLevel < g->raiseDelay) {
+      g->raiseDelay *= 2;
+      if (g->raiseDelay > MAX_RAISE_DELAY) {
+        g->raiseDelay = MAX_RAISE_DELAY;
+      }
+    }
+    setLevel(g, g->level + 1);
+    return true;
+  }
+
+  if (g->average < g->targetFrameTime * FAST_FACTOR && g->level > g->bestLevel &&
+      g->framesAtLevel >= g->raiseDelay) {
+    setLevel(g, g->level - 1);
+    return true;
+  }
+  return false;
+}
+
+void governorLevelFailed(FrameGovernor* g) {
+  if (g->level + 1 < LEVEL_COUNT) {
+    g->bestLevel = g->level + 1;
+    setLevel(g, g->level + 1);
+  }
+}
+
+ResolutionLevel governorLevel(const FrameGovernor* g) {
+  ResolutionLevel l = levels[g->level];
+  if (l.samples > g->maxSamples) {
+    l.samples = g->maxSamples;
+  }
+  return l;
+}
@@ -0,0 +1,52 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <stdbool.h>
+
+// Picks the internal resolution and MSAA the renderer draws at so that
+// frames keep up with the target frame time. It watches the work of each
+// frame, from the start of render to the frame presented, not the time
+// between frames: a display or a browser that paces frames at 30 or 50 Hz
+// would look like an overloaded GPU. When the work takes too much of the
+// frame it steps down a level, when it has left room for a while it tries
+// the level above again. A level that had to be given up right away waits
+// twice as long before the next try.
+
+// Frame time the work has to fit in, the 60 Hz of most displays. Slower
+// displays only give it more room
+#define GOVERNOR_TARGET_FRAME_TIME (1.0f / 60.0f)
+
+typedef struct {
+    float scale;            // of the drawable size, per axis
+    int samples;            // MSAA samples, 0 for none
+} ResolutionLevel;
+
+typedef struct {
+    float targetFrameTime;
+    int maxSamples;         // what the GPU supports
+
+    float average;          // smoothed work time
+
+    int level;              // index in the level table, 0 is the best
+    int bestLevel;          // raises stop there, levels above it failed
+    int framesAtLevel;
+    int raiseDelay;         // frames on time before trying the level above
+    bool raised;            // the current level was reached by a raise
+} FrameGovernor;
+
+
+void initFrameGovernor(FrameGovernor* g, float targetFrameTime, int maxSamples);
+
+// Feeds the work time of a frame, in seconds. true when the level changed,
+// the new one applies from the next frame
+bool governFrame(FrameGovernor* g, float workTime);
+
+// The renderer could not allocate the current level: drops to the next one
+// and never raises back to it
+void governorLevelFailed(FrameGovernor* g);
+
+// Resolution and MSAA of the current level, samples clamped to maxSamples
+ResolutionLevel governorLevel(const FrameGovernor* g);
+
+
+#endif
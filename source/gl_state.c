@@ -0,0 +1,236 @@
+/**
+ * GL state cache.
+ * Binds, uniform writes and fixed function state are compared against the
+ * last value set before reaching GL. The cache is only valid as long as
+ * nothing calls GL behind its back, see gl_state.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gl_state.h"
+
+
+// Texture units tracked, the renderer only samples unit 0
+#define CACHED_TEXTURE_UNITS 4
+
+typedef struct {
+    GLuint program;
+    GLuint vao;
+    GLuint arrayBuffer;
+    GLuint drawFramebuffer;
+    GLuint readFramebuffer;
+
+    GLenum activeUnit;
+    GLuint texture[CACHED_TEXTURE_UNITS];
+
+    GLint uniform[CACHED_UNIFORMS];
+    bool uniformKnown[CACHED_UNIFORMS];
+
+    GLint viewport[4];
+    GLfloat clearColor[4];
+    bool blend;
+    GLenum blendSrc;
+    GLenum blendDst;
+} GlState;
+
+static GlState state;
+static GlCallStats stats;
+
+
+void initGlState(void) {
+  memset(&state, 0, sizeof(state));
+
+  // defaults of a new context, the viewport is unknown until set once
+  state.activeUnit = GL_TEXTURE0;
+  state.viewport[2] = -1;
+  state.blend = false;
+  state.blendSrc = GL_ONE;
+  state.blendDst = GL_ZERO;
+}
+
+// true if the call has to reach GL, counts it either way
+static bool changed(bool differs) {
+  if (differs) {
+    stats.issued++;
+  } else {
+    stats.filtered++;
+  }
+  return differs;
+}
+
+void useProgramCached(GLuint program) {
+  if (changed(program != state.program)) {
+    glUseProgram(program);
+    state.program = program;
+
+    // uniform values belong to the program
+    memset(state.uniformKnown, 0, sizeof(state.uniformKnown));
+  }
+}
+
+void bindVertexArrayCached(GLuint vao) {
+  if (changed(vao != state.vao)) {
+    glBindVertexArray(vao);
+    state.vao = vao;
+  }
+}
+
+void bindFramebufferCached(GLenum target, GLuint fbo) {
+  bool draw = target == GL_DRAW_FRAMEBUFFER || target == GL_FRAMEBUFFER;
+  bool read = target == GL_READ_FRAMEBUFFER || target == GL_FRAMEBUFFER;
+
+  if (changed((draw && fbo != state.drawFramebuffer) || (read && fbo != state.readFramebuffer))) {
+    glBindFramebuffer(target, fbo);
+    if (draw) state.drawFramebuffer = fbo;
+    if (read) state.readFramebuffer = fbo;
+  }
+}
+
+void bindBufferCached(GLenum target, GLuint buffer) {
+  if (target != GL_ARRAY_BUFFER) {
+    countGlCall();
+    glBindBuffer(target, buffer);
+    return;
+  }
+  if (changed(buffer != state.arrayBuffer)) {
+    glBindBuffer(target, buffer);
+    state.arrayBuffer = buffer;
+  }
+}
+
+void activeTextureCached(GLenum unit) {
+  if (changed(unit != state.activeUnit)) {
+    glActiveTexture(unit);
+    state.activeUnit = unit;
+  }
+}
+
+void bindTextureCached(GLuint texture) {
+  unsigned unit = state.activeUnit - GL_TEXTURE0;
+  if (unit >= CACHED_TEXTURE_UNITS) {
+    countGlCall();
+    stats.textureBindsIssued++;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    return;
+  }
+  if (changed(texture != state.texture[unit])) {
+    stats.textureBindsIssued++;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    state.texture[unit] = texture;
+  } else {
+    stats.textureBindsFiltered++;
+  }
+}
+
+void uniform1iCached(GLint location, GLint value) {
+  if (location < 0 || location >= CACHED_UNIFORMS) {
+    countGlCall();
+    glUniform1i(location, value);
+    return;
+  }
+  if (changed(!state.uniformKnown[location] || state.uniform[location] != value)) {
+    glUniform1i(location, value);
+    state.uniform[location] = value;
+    state.uniformKnown[location] = true;
+  }
+}
+
+void viewportCached(GLint x, GLint y, GLsizei width, GLsizei height) {
+  GLint* v = state.viewport;
+  if (changed(v[0] != x || v[1] != y || v[2] != width || v[3] != height)) {
+    glViewport(x, y, width, height);
+    v[0] = x;
+    v[1] = y;
+    v[2] = width;
+    v[3] = height;
+  }
+}
+
+void clearColorCached(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  GLfloat* c = state.clearColor;
+  if (changed(c[0] != r || c[1] != g || c[2] != b || c[3] != a)) {
+    glClearColor(r, g, b, a);
+    c[0] = r;
+    c[1] = g;
+    c[2] = b;
+    c[3] = a;
+  }
+}
+
+void enableCached(GLenum cap, bool enabled) {
+  if (cap != GL_BLEND) {
+    countGlCall();
+    if (enabled) {
+      glEnable(cap);
+    } else {
+      glDisable(cap);
+    }
+    return;
+  }
+  if (changed(enabled != state.blend)) {
+    if (enabled) {
+      glEnable(cap);
+    } else {
+      glDisable(cap);
+    }
+    state.blend = enabled;
+  }
+}
+
+void blendFuncCached(GLenum src, GLenum dst) {
+  if (changed(src != state.blendSrc || dst != state.blendDst)) {
+    glBlendFunc(src, dst);
+    state.blendSrc = src;
+    state.blendDst = dst;
+  }
+}
+
+void deleteBufferCached(GLuint buffer) {
+  countGlCall();
+  glDeleteBuffers(1, &buffer);
+  if (state.arrayBuffer == buffer) {
+    state.arrayBuffer = 0;
+  }
+}
+
+void deleteVertexArrayCached(GLuint vao) {
+  countGlCall();
+  glDeleteVertexArrays(1, &vao);
+  if (state.vao == vao) {
+    state.vao = 0;
+  }
+}
+
+void deleteTextureCached(GLuint texture) {
+  countGlCall();
+  glDeleteTextures(1, &texture);
+  for (int u = 0; u < CACHED_TEXTURE_UNITS; u++) {
+    if (state.texture[u] == texture) {
+      state.texture[u] = 0;
+    }
+  }
+}
+
+void deleteFramebufferCached(GLuint fbo) {
+  countGlCall();
+  glDeleteFramebuffers(1, &fbo);
+  if (state.drawFramebuffer == fbo) {
+    state.drawFramebuffer = 0;
+  }
+  if (state.readFramebuffer == fbo) {
+    state.readFramebuffer = 0;
+  }
+}
+
+void countGlCall(void) {
+  stats.issued++;
+}
+
+GlCallStats glCallStats(void) {
+  return stats;
+}
+
+void resetGlCallStats(void) {
+  memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,61 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <stdbool.h>
+#include <GLES3/gl3.h>
+
+// Shadow copy of the GL state the renderer touches. The cached calls skip
+// the GL call when the value is already current, every WebGL call crosses
+// into JS. All GL state changes must go through them, or the cache lies.
+
+// Uniform locations whose value is cached, higher ones are always written
+#define CACHED_UNIFORMS 16
+
+// GL calls of the current frame
+typedef struct {
+    int issued;             // reached the driver
+    int filtered;           // dropped, the state already had that value
+
+    int textureBindsIssued; // bindTextureCached calls, also in the totals
+    int textureBindsFiltered;
+} GlCallStats;
+
+
+// Puts the cache in the state of a fresh context
+void initGlState(void);
+
+void useProgramCached(GLuint program);
+void bindVertexArrayCached(GLuint vao);
+
+// GL_DRAW_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_FRAMEBUFFER for both
+void bindFramebufferCached(GLenum target, GLuint fbo);
+
+// Only GL_ARRAY_BUFFER is cached, the element buffer belongs to the VAO
+void bindBufferCached(GLenum target, GLuint buffer);
+
+void activeTextureCached(GLenum unit);
+void bindTextureCached(GLuint texture);     // GL_TEXTURE_2D, active unit
+
+// Integer uniform of the current program
+void uniform1iCached(GLint location, GLint value);
+
+void viewportCached(GLint x, GLint y, GLsizei width, GLsizei height);
+void clearColorCached(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void enableCached(GLenum cap, bool enabled);    // GL_BLEND only
+void blendFuncCached(GLenum src, GLenum dst);
+
+// Deleting a bound object unbinds it, these keep the cache in sync
+void deleteBufferCached(GLuint buffer);
+void deleteVertexArrayCached(GLuint vao);
+void deleteTextureCached(GLuint texture);
+void deleteFramebufferCached(GLuint fbo);
+
+// For the calls that always go through (uploads, clears, draws)
+void countGlCall(void);
+
+// Stats since the last reset, render resets them every frame
+GlCallStats glCallStats(void);
+void resetGlCallStats(void);
+
+
+#endif
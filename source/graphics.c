@@ -1,12 +1,21 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <GLES2/gl2.h>
-#include <emscripten.h>
-#include <emscripten/html5.h>
+#include <GLES3/gl3.h>
 
 #include "graphics.h"
 #include "entity.h"
 #include "world.h"
+#include "texture.h"
+#include "mesh.h"
+#include "sprite_batch.h"
+#include "platform.h"
+#include "hud.h"
+#include "profiler.h"
+#include "gl_state.h"
+#include "render_target.h"
+#include "frame_governor.h"
+#include "asset_loader.h"
+#include "startup.h"
 /*
 ======================================================================
                     Vertices & Shaders 
@@ -17,20 +26,22 @@ const char* vertex_shader =
 "precision mediump float;\n"
 "layout(location = 0) in vec2 aPos;\n"       // position (x,y)
 "layout(location = 1) in vec2 aTexCoord;\n"  // texture coords (u,v)
-"uniform vec2 u_translation;\n"
-"uniform float u_angle;\n"
+"layout(location = 2) in vec2 aTranslation;\n" // per instance, NDC
+"layout(location = 3) in float aAngle;\n"      // per instance
+"layout(location = 4) in vec2 aScale;\n"       // per instance, half size
+"layout(location = 5) in vec4 aUvRect;\n"      // per instance, atlas rect
 "out vec2 v_texCoord;\n"
 "void main() {\n"
-"   float cosA = cos(u_angle);\n"
-"   float sinA = sin(u_angle);\n"
+"   float cosA = cos(aAngle);\n"
+"   float sinA = sin(aAngle);\n"
 "   mat2 rotation = mat2(\n"
 "       cosA,  sinA,\n"
 "       -sinA,  cosA\n"
 "    );\n"
-"    vec2 rotatedPos = rotation * aPos;\n"
-"    vec2 finalPos = rotatedPos + u_translation;\n"
+"    vec2 rotatedPos = rotation * (aPos * aScale);\n"
+"    vec2 finalPos = rotatedPos + aTranslation;\n"
 "    gl_Position = vec4(finalPos, 0.0, 1.0);\n"
-"    v_texCoord = aTexCoord;\n"
+"    v_texCoord = mix(aUvRect.xy, aUvRect.zw, aTexCoord);\n"
 "}\n";
 
 
@@ -47,11 +58,32 @@ const char* fragment_shader =
 
 GLuint program;            // The shader program
 GLint position_location;   // attribute location: aPos
-GLint translation_location; // uniform: u_translation
-GLint angle_location;       // uniform: u_angle
 GLint texCoord_location;
+GLint translation_location; // attribute location: aTranslation (per instance)
+GLint angle_location;       // attribute location: aAngle (per instance)
+GLint scale_location;       // attribute location: aScale (per instance)
+GLint uvRect_location;      // attribute location: aUvRect (per instance)
 GLint texture_location;
 
+// sprites of the current frame, reused every frame
+static RenderList frameList;
+
+// score and lives, drawn after the entities
+static Hud hud;
+
+// offscreen frame, its size and MSAA picked by the governor every frame
+static RenderTarget target;
+static FrameGovernor governor;
+
+// loading phase, the game is drawn once every texture is uploaded
+static AssetLoader loader;
+static bool loading = true;
+static double uploadBegin = 0.0;
+
+// print the batch stats every RENDER_STATS_PERIOD frames
+#define RENDER_STATS_PERIOD 600
+static int frameCount = 0;
+
 // Error checking functions
 void checkShaderCompilation(GLuint shader) {
   GLint success;
@@ -110,97 +142,140 @@ GLuint createProgram(const char* vertex_src, const char* fragment_src) {
 }
 
 // Initializes global shader state (only done once)
-void initGraphics() {
+void initGraphics(void) {
+    // nothing has touched the context yet
+    initGlState();
+
     program = createProgram(vertex_shader, fragment_shader);
-    glUseProgram(program);
+    useProgramCached(program);
 
     position_location = glGetAttribLocation(program, "aPos");
     texCoord_location = glGetAttribLocation(program, "aTexCoord");
-    translation_location = glGetUniformLocation(program, "u_translation");
-    angle_location       = glGetUniformLocation(program, "u_angle");
+    translation_location = glGetAttribLocation(program, "aTranslation");
+    angle_location       = glGetAttribLocation(program, "aAngle");
+    scale_location       = glGetAttribLocation(program, "aScale");
+    uvRect_location      = glGetAttribLocation(program, "aUvRect");
     texture_location     = glGetUniformLocation(program, "u_texture");
 
     // for safety checks
     if (position_location < 0 || texCoord_location < 0 ||
         translation_location < 0 || angle_location < 0 ||
+        scale_location < 0 || uvRect_location < 0 ||
         texture_location < 0) {
         printf("Error retrieving graphical attribute in function initGraphics\n");
         exit(1);
     }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-}
+    enableCached(GL_BLEND, true);
+    // the bundle pixels are premultiplied
+    blendFuncCached(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
+    // meshes are uploaded once here, textures during the first frames,
+    // entities share them
+    startAssetLoad(&loader, ASSET_BUNDLE_PATH);
+    initMeshes();
 
-void render(World* w) {
+    initSpriteBatch();
+    initRenderList(&frameList);
+    initHud(&hud);
 
-  // Get current GL context
-  EMSCRIPTEN_WEBGL_CONTEXT_HANDLE ctx = emscripten_webgl_get_current_context();
+    GLint maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    initRenderTarget(&target);
+    initFrameGovernor(&governor, GOVERNOR_TARGET_FRAME_TIME, maxSamples);
+}
 
-  int width = 1000, height = 1000;
-  emscripten_webgl_get_drawing_buffer_size(ctx, &width, &height);
 
-  // Setup viewport and clear
-  glViewport(0, 0, width, height);
-  glClearColor(0.0, 0.0, 0.0, 1.0);
-  glClear(GL_COLOR_BUFFER_BIT);
+// One step of the loading phase: waits for the bundle, then uploads
+// UPLOAD_BUDGET of it. true once the game can be drawn
+static bool loadAssets(void) {
+  if (!loading) {
+    return true;
+  }
+  if (!assetsRead(&loader)) {
+    return false;
+  }
 
-  // Use our shader program
-  glUseProgram(program);
+  if (uploadBegin == 0.0) {
+    uploadBegin = platformWallNow();
+  }
+  // without a bundle the sprites are drawn untextured rather than never
+  if (loader.ok && !uploadTextures(&loader.bundle, UPLOAD_BUDGET)) {
+    return false;
+  }
 
-  // Traverse the linked list of entities
-  for (EntityNode* node = w->head; node != NULL; node = node->next) {
+  startupStage(STARTUP_UPLOAD, uploadBegin, platformWallNow());
+  finishAssetLoad(&loader);
+  loading = false;
+  return true;
+}
 
-    Entity* e = node->e;
-    if (e->vbo == 0 || e->ebo == 0) {
-      continue;
-    }
+void render(const WorldSnapshot* snap) {
+
+  int width, height;
+  platformDrawableSize(&width, &height);
+  resetGlCallStats();
+
+  // Loading phase: the canvas stays black and the governor is left out,
+  // these frames say nothing about the cost of drawing
+  if (!loadAssets()) {
+    bindFramebufferCached(GL_DRAW_FRAMEBUFFER, 0);
+    viewportCached(0, 0, width, height);
+    clearColorCached(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    countGlCall();
+    return;
+  }
 
-    // 1) Compute normalized device coords for translation
-    float ndc_x = (e->x / (float)width);
-    float ndc_y = (e->y / (float)height);
-
-    // 2) Set uniforms: translation + angle
-    glUniform2f(translation_location, ndc_x, ndc_y);
-    glUniform1f(angle_location, e->angle);
-
-    // 3) Bind the texture for this entity (if each entity has its own texture)
-    //    or bind a single global texture if you prefer
-    glActiveTexture(GL_TEXTURE0);               // set active texture unit to 0
-    glBindTexture(GL_TEXTURE_2D, e->textureId); // or some global texture
-    glUniform1i(texture_location, 0);           // 0 means GL_TEXTURE0
-
-    // 4) Bind this entity's VBO/EBO
-    glBindBuffer(GL_ARRAY_BUFFER, e->vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e->ebo);
-
-    // 5) Setup the vertex attribute pointers:
-    //    a) position (x,y) at layout=0
-    glEnableVertexAttribArray(position_location);
-    glVertexAttribPointer(position_location,
-                          2,
-                          GL_FLOAT,
-                          GL_FALSE,
-                          4 * sizeof(GLfloat),   // stride => x,y,u,v
-                          (void*)0);
-
-    //    b) texcoord (u,v) at layout=1
-    glEnableVertexAttribArray(texCoord_location);
-    glVertexAttribPointer(texCoord_location,
-                          2,
-                          GL_FLOAT,
-                          GL_FALSE,
-                          4 * sizeof(GLfloat),   // same stride
-                          (void*)(2 * sizeof(GLfloat))); // offset after x,y
-
-    // 6) Draw
-    glDrawElements(GL_TRIANGLES, e->numIndices, GL_UNSIGNED_SHORT, 0);
-
-    // 7) Disable the vertex attribute arrays
-    glDisableVertexAttribArray(position_location);
-    glDisableVertexAttribArray(texCoord_location);
+  // Internal resolution: the drawable scaled by the governor level
+  double frameStart = platformWallNow();
+  ResolutionLevel level = governorLevel(&governor);
+  int targetWidth = (int)(width * level.scale + 0.5f);
+  int targetHeight = (int)(height * level.scale + 0.5f);
+  if (!resizeRenderTarget(&target, targetWidth, targetHeight, level.samples, width, height)) {
+    // this frame goes straight to the canvas, the next one a level lower
+    governorLevelFailed(&governor);
   }
-}
+  bindRenderTarget(&target);
 
+  // Setup viewport and clear, only the clear reaches GL once it is set up
+  viewportCached(0, 0, target.width, target.height);
+  clearColorCached(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  countGlCall();
 
+  // Use our shader program
+  useProgramCached(program);
+
+  // The whole world and the HUD go through the sprite batch: one texture,
+  // one draw
+  clearRenderList(&frameList);
+  buildRenderList(&frameList, snap, snapshotAlpha(snap, platformNow()),
+                  LAYOUT_WIDTH, LAYOUT_HEIGHT);
+
+  PROFILE_BEGIN(updateHud);
+  updateHud(&hud, snap->score, snap->lives, LAYOUT_WIDTH, LAYOUT_HEIGHT);
+  drawHud(&hud, &frameList);
+  PROFILE_END(updateHud);
+
+  flushSpriteBatch(&frameList);
+
+  // Resolve and scale up to the canvas
+  presentRenderTarget(&target, width, height);
+  startupFrameDrawn();
+
+  // the level for the next frame, from what this one cost
+  governFrame(&governor, (float)(platformWallNow() - frameStart));
+
+  if (++frameCount % RENDER_STATS_PERIOD == 0) {
+    SpriteBatchStats stats = spriteBatchStats();
+    GlCallStats calls = glCallStats();
+    printf("render     sprites %d   draw calls %d   "
+           "texture binds %d issued %d filtered   "
+           "gl calls %d issued %d filtered   target %dx%d msaa %d of %dx%d\n",
+           stats.sprites, stats.drawCalls,
+           calls.textureBindsIssued, calls.textureBindsFiltered,
+           calls.issued, calls.filtered,
+           target.width, target.height, target.samples, width, height);
+  }
+}
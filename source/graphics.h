@@ -4,10 +4,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <GLES2/gl2.h>
-#include <emscripten.h>
-#include <emscripten/html5.h>
+#include <GLES3/gl3.h>
 
+#include "renderer.h"
 #include "world.h"
 #include "entity.h"
 
@@ -15,14 +14,15 @@
 GLuint compileShader(GLenum type, const char* source);
 GLuint createProgram(const char* vertex_src, const char* fragment_src);
 
-void initGraphics();
-void render(World* w);
-
 // Global variables
 extern GLuint program;
 extern GLint position_location;
+extern GLint texCoord_location;
 extern GLint translation_location; 
 extern GLint angle_location;
+extern GLint scale_location;
+extern GLint uvRect_location;
+extern GLint texture_location;
 
 // Shader source declarations
 extern const char* vertex_shader;
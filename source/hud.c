@@ -0,0 +1,73 @@
+/**
+ * In-canvas HUD.
+ * The text is laid out into a small render list of glyph sprites which is
+ * kept between frames: a frame only copies it into the batch, the layout
+ * is redone when the score, the lives or the canvas size change.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hud.h"
+#include "atlas.h"
+
+
+// Glyphs are 5x7 font pixels, one pixel of spacing
+#define GLYPH_COLUMNS 5
+#define GLYPH_ROWS 7
+#define GLYPH_ADVANCE 6
+
+
+void initHud(Hud* h) {
+  h->score = -1;
+  h->lives = -1;
+  h->width = 0;
+  h->height = 0;
+  initRenderList(&h->glyphs);
+}
+
+void freeHud(Hud* h) {
+  freeRenderList(&h->glyphs);
+}
+
+// -1 for characters the font does not have, drawn as a space
+static int glyphOf(char c) {
+  const char* found = c != '\0' ? strchr(GLYPH_CHARSET, c) : NULL;
+  return found ? (int)(found - GLYPH_CHARSET) : -1;
+}
+
+bool updateHud(Hud* h, int score, int lives, int width, int height) {
+  if (score == h->score && lives == h->lives &&
+      width == h->width && height == h->height) {
+    return false;
+  }
+  h->score = score;
+  h->lives = lives;
+  h->width = width;
+  h->height = height;
+
+  char text[HUD_TEXT_SIZE];
+  snprintf(text, sizeof(text), "SCORE: %d   LIVES: %d", score, lives);
+
+  // pixels to normalised device coordinates, y goes up
+  float halfWidth = (float)(GLYPH_COLUMNS * HUD_PIXEL) / width;
+  float halfHeight = (float)(GLYPH_ROWS * HUD_PIXEL) / height;
+  float y = 1.0f - 2.0f * HUD_MARGIN / height - halfHeight;
+
+  clearRenderList(&h->glyphs);
+  for (int i = 0; text[i] != '\0'; i++) {
+    int glyph = glyphOf(text[i]);
+    if (glyph < 0) {
+      continue;
+    }
+
+    float x = -1.0f + 2.0f * (HUD_MARGIN + i * GLYPH_ADVANCE * HUD_PIXEL) / width + halfWidth;
+    pushSprite(&h->glyphs, (SpriteId)(SPRITE_GLYPH_FIRST + glyph), x, y, 0.0f,
+               halfWidth, halfHeight);
+  }
+  return true;
+}
+
+void drawHud(const Hud* h, RenderList* frame) {
+  appendRenderList(frame, &h->glyphs);
+}
@@ -0,0 +1,39 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <stdbool.h>
+#include "render_list.h"
+
+// Score and lives drawn in the canvas with the glyphs of the atlas, as
+// sprites of the same batch as the entities
+
+// Size of a font pixel and margin to the top left corner, in drawable pixels
+#define HUD_PIXEL 3
+#define HUD_MARGIN 10
+
+// Longest HUD line
+#define HUD_TEXT_SIZE 48
+
+typedef struct {
+    // what the glyphs show, -1 until the first update
+    int score;
+    int lives;
+    int width;
+    int height;
+
+    RenderList glyphs;      // one sprite per visible character
+} Hud;
+
+
+void initHud(Hud* h);
+void freeHud(Hud* h);
+
+// Lays the glyphs out again, only when a value or the drawable size
+// changed. Returns true when it did
+bool updateHud(Hud* h, int score, int lives, int width, int height);
+
+// Appends the glyphs to the sprites of the frame
+void drawHud(const Hud* h, RenderList* frame);
+
+
+#endif
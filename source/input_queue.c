@@ -1,11 +1,11 @@
+
 /**
- * The goal of this structure is to be used in Emscripten callbacks.
- * It's a FIFO queue in which we overwrite the oldest elements in case of overflow.
- * Implemented as a circular buffer.
+ * Lock free single producer / single consumer ring.
+ * The producer publishes an event by storing tail with release ordering
+ * after writing the slot, the consumer reads tail with acquire ordering
+ * before reading the slots. The same pairing on head hands the slots back.
  */
 
-#include <emscripten.h>
-#include <emscripten/html5.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "input_queue.h"
@@ -13,37 +13,38 @@
 
 // Initialize the queue
 void initQueue(InputQueue* q) {
-    q->head = 0;
-    q->tail = 0;
-    q->size = 0;
-    q->capacity = QUEUE_CAP;
+    atomic_store_explicit(&q->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->tail, 0, memory_order_relaxed);
+    q->dropped = 0;
 }
 
-void enqueue(InputQueue* q, InputEvent ev) {
-    // If at capacity, we drop the oldest event by moving head forward
-    if (q->size == q->capacity) {
-        q->head = (q->head + 1) % q->capacity;
-        q->size--;
+bool enqueue(InputQueue* q, InputEvent ev) {
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    // Full, the consumer is a whole ring behind
+    if (tail - head == QUEUE_CAP) {
+        q->dropped++;
+        return false;
     }
 
-    // Write the new event at the tail index
-    q->buffer[q->tail] = ev;
-    // Move tail forward (circularly)
-    q->tail = (q->tail + 1) % q->capacity;
-    // Increase size
-    q->size++;
+    q->buffer[tail & QUEUE_MASK] = ev;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
 }
 
-InputEvent pop(InputQueue* q) {
-    
+int drainQueue(InputQueue* q, InputEvent* out, int max) {
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
 
-  InputEvent out = q->buffer[q->head];
-  q->head = (q->head + 1) % q->capacity;
-  q->size--;
+    uint32_t available = tail - head;
+    int count = available < (uint32_t)max ? (int)available : max;
 
-  return out;
-}
+    for (int i = 0; i < count; i++) {
+        out[i] = q->buffer[(head + i) & QUEUE_MASK];
+    }
 
-int isEmpty(const InputQueue* q) {
-    return (q->size == 0);
+    // one store hands the whole batch back to the producer
+    atomic_store_explicit(&q->head, head + count, memory_order_release);
+    return count;
 }
@@ -2,44 +2,50 @@
 #define INPUT_QUEUE_H
 
 
-#include <emscripten.h>
-#include <emscripten/html5.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "command.h"
 
-#define QUEUE_CAP 100
+// Power of two, indices are masked instead of taken modulo
+#define QUEUE_CAP 128
+#define QUEUE_MASK (QUEUE_CAP - 1)
 
-typedef enum {
-    KEYBOARD,
-    MOUSE,
-} EventType;
+// Keeps head and tail on their own cache lines, no false sharing between
+// the producer and the consumer
+#define CACHE_LINE 64
 
+// A key press already translated by the bindings, 8 bytes instead of a
+// copy of the browser event
 typedef struct {
-    EventType event_type;
-    union {
-        EmscriptenKeyboardEvent keyboard; 
-        EmscriptenMouseEvent    mouse;
-    } event_data;
+    uint8_t command;        // Command
+    float time;             // ms, timestamp of the event
 } InputEvent;
 
+// Single producer (input callbacks), single consumer (simulation) ring.
+// head and tail only ever grow, tail - head is the number of queued events.
+// Each side writes its own index and reads the other one, so neither needs
+// a lock and neither can block the other.
 typedef struct {
-    InputEvent buffer[QUEUE_CAP];  // storage for events
-    int head;                      // index of the oldest event
-    int tail;                      // index where the next event will be written
-    int size;                      // how many events are currently in the queue
-    int capacity;                  // max capacity (e.g. 1024)
+    InputEvent buffer[QUEUE_CAP];
+
+    _Alignas(CACHE_LINE) _Atomic uint32_t tail;    // written by the producer
+    uint32_t dropped;                             // events refused, queue full
+
+    _Alignas(CACHE_LINE) _Atomic uint32_t head;    // written by the consumer
 } InputQueue;
 
 
 // Initialize the queue
 void initQueue(InputQueue* q);
 
-// adds an element to the queue
-void enqueue(InputQueue* q, InputEvent ev);
-
-InputEvent pop(InputQueue* q);
+// Producer side, false and the event is dropped if the queue is full
+bool enqueue(InputQueue* q, InputEvent ev);
 
-int isEmpty(const InputQueue* q);
+// Consumer side, moves up to max events to out in one go, returns how many
+int drainQueue(InputQueue* q, InputEvent* out, int max);
 
 
 #endif
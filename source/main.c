@@ -1,77 +1,158 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <GLES2/gl2.h>
-#include <emscripten.h>
-#include <emscripten/html5.h>
-#include <unistd.h>
+#include <string.h>
+#include <time.h>
 
 
 #include "entity.h"
-#include "controls.h"
 #include "input_queue.h"
-#include "graphics.h"
+#include "platform.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "replay.h"
+#include "sim_thread.h"
+#include "snapshot.h"
+#include "startup.h"
 #include "world.h"
 
 typedef struct {
     InputQueue* iq;
     World* w;
+    SnapshotBuffer* snapshots;
 } MainLoopArgs;
 
 void main_loop(void* arg) {
   MainLoopArgs* args = (MainLoopArgs*)arg;
-  InputQueue* iq = args->iq;
-  World* w = args->w;
 
-  // If the list is empty or head is gone, skip
-  if (w->head) {
-    registerInputs(iq, w->head->e);
-  }
+#ifndef SIM_THREAD
+  // no simulation thread, the frame runs it first
+  simulateFrame(args->w, args->iq, args->snapshots);
+#endif
 
-  updateWorldState(w);
-  render(w);
+  // render only sees the last complete snapshot, the HUD included
+  PROFILE_BEGIN(render);
+  render(latestSnapshot(args->snapshots));
+  PROFILE_END(render);
 }
 
 
-int main() {
+// Plays a recording back with no live input and no frame pacing,
+// one render per tick, and reports the CPU time it took
+static int runReplay(const char* path) {
+  Replay replay;
+  if (!loadReplay(&replay, path)) {
+    return 1;
+  }
+
+  initGraphics();
 
-  //  WebGL context attributes
-  EmscriptenWebGLContextAttributes attr;
-  emscripten_webgl_init_context_attributes(&attr);
-  attr.alpha = EM_TRUE;
-  attr.depth = EM_TRUE;
-  attr.stencil = EM_FALSE;
-  attr.antialias = EM_TRUE;
-  attr.majorVersion = 2;
+  World world;
+  initWorld(&world, replay.seed);
+  setTickRate(&world, replay.tickRate);
+  world.alpha = 1.0f;
 
-  // WebGL context
-  EMSCRIPTEN_WEBGL_CONTEXT_HANDLE ctx = emscripten_webgl_create_context("#canvas", &attr);
-  if (ctx <= 0) {
-    printf("Failed to create WebGL context\n");
+  SnapshotBuffer snapshots;
+  if (!initSnapshotBuffer(&snapshots, world.entities.capacity)) {
     return 1;
   }
 
-  // Make the context current
-  emscripten_webgl_make_context_current(ctx);
+  clock_t start = clock();
+
+  while (!replayFinished(&replay, world.tick)) {
+    Command command;
+    while (nextReplayCommand(&replay, world.tick, &command)) {
+      queueCommand(&world, command);
+    }
+
+    stepWorld(&world, world.tickDt);
+    publishSnapshot(&snapshots, &world, platformNow());
+
+    PROFILE_BEGIN(render);
+    render(latestSnapshot(&snapshots));
+    PROFILE_END(render);
+  }
+
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("replay     %u ticks in %.3f s   %.2f us per tick   checksum %08x\n",
+         world.tick, seconds, world.tick > 0 ? seconds * 1e6 / world.tick : 0.0,
+         worldChecksum(&world));
+  printWorldStats(&world);
+  PROFILE_DUMP(PROFILE_FILE);
+
+  freeReplay(&replay);
+  freeSnapshotBuffer(&snapshots);
+  freeWorld(&world);
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  // everything before main: wasm download, instantiate and preload
+  startupStage(STARTUP_INSTANTIATE, platformStartTime(), platformWallNow());
+
+  // headless build: asteroid --replay file
+  if (argc >= 3 && strcmp(argv[1], "--replay") == 0) {
+    return runReplay(argv[2]);
+  }
+
+  // WebGL context in the browser, nothing in the headless build
+  if (!platformInit()) {
+    return 1;
+  }
 
   // Initialize OpenGL state
   initGraphics();
 
 
   World world;
-  initWorld(&world);
+  uint64_t seed = platformSeed();
+  initWorld(&world, seed);
+  printf("World seed %llu\n", (unsigned long long)seed);
+
+#ifdef RECORD_INPUT
+  // saved on every game over, see restartWorld
+  static Recorder recorder;
+  if (startRecording(&recorder, seed, world.tickRate)) {
+    world.recorder = &recorder;
+  }
+#endif
 
+  // the only state render shares with the simulation
+  static SnapshotBuffer snapshots;
+  if (!initSnapshotBuffer(&snapshots, world.entities.capacity)) {
+    return 1;
+  }
 
-  InputQueue iq;
+
+  static InputQueue iq;
   initQueue(&iq);
-  handleInput(&iq);
+  platformHookInput(&iq);
 
 
   MainLoopArgs loopArgs;
   loopArgs.iq = &iq;
   loopArgs.w = &world;
+  loopArgs.snapshots = &snapshots;
+
+#ifdef SIM_THREAD
+  // from here on the World belongs to the simulation thread
+  static SimThread sim;
+  if (!startSimThread(&sim, &world, &iq, &snapshots)) {
+    return 1;
+  }
+#endif
+
 
+  platformRunLoop(main_loop, &loopArgs);
 
-  emscripten_set_main_loop_arg(main_loop, &loopArgs, 0, 1);
+  // only the headless loop ever returns
+#ifdef SIM_THREAD
+  stopSimThread(&sim);
+#endif
+  printWorldStats(&world);
+  PROFILE_DUMP(PROFILE_FILE);
 
+  freeSnapshotBuffer(&snapshots);
+  freeWorld(&world);
   return 0;
 }
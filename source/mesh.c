@@ -0,0 +1,98 @@
+/**
+ * Mesh registry.
+ * The meshes are uploaded once at initGraphics time,
+ * spawning or removing an entity does not touch any GL buffer.
+ * Each mesh records its attribute layout in a VAO, drawing it is one bind.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GLES3/gl3.h>
+
+#include "mesh.h"
+#include "graphics.h"
+#include "gl_state.h"
+
+/*
+===================================================================
+                 VERTICES
+===================================================================
+*/ 
+
+// Unit quad, scaled by the half size of each sprite in the shader
+static const GLfloat verticesQuad[] = {
+  //  x,     y,     u,    v
+  -1.0f, -1.0f,  0.0f, 0.0f,  // bottom-left
+  1.0f, -1.0f,   1.0f, 0.0f,  // bottom-right
+  1.0f,  1.0f,   1.0f, 1.0f,  // top-right
+  -1.0f,  1.0f,  0.0f, 1.0f   // top-left
+};
+
+// drawn as two triangles
+static const GLushort indicesQuad[] = {
+  0, 1, 2, // Triangle 1
+  0, 2, 3  // Triangle 2
+};
+
+static const GLfloat* meshVertices[MESH_COUNT] = {
+  [MESH_QUAD] = verticesQuad,
+};
+
+static Mesh meshes[MESH_COUNT];
+
+
+void initMeshes(void) {
+  for (int i = 0; i < MESH_COUNT; i++) {
+    Mesh* m = &meshes[i];
+
+    // 1) The VAO records everything below
+    glGenVertexArrays(1, &m->vao);
+    bindVertexArrayCached(m->vao);
+
+    // 2) Generate and fill the VBO, 4 vertices of x,y,u,v
+    glGenBuffers(1, &m->vbo);
+    bindBufferCached(GL_ARRAY_BUFFER, m->vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 sizeof(GLfloat) * 16,
+                 meshVertices[i],
+                 GL_STATIC_DRAW);
+
+    // 3) Generate and fill the EBO
+    glGenBuffers(1, &m->ebo);
+    bindBufferCached(GL_ELEMENT_ARRAY_BUFFER, m->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 sizeof(indicesQuad),
+                 indicesQuad,
+                 GL_STATIC_DRAW);
+
+    m->numIndices = sizeof(indicesQuad)/sizeof(indicesQuad[0]);
+
+    // 4) Per vertex attributes, position then texture coordinates
+    glVertexAttribPointer(position_location, 2, GL_FLOAT, GL_FALSE,
+                          4 * sizeof(GLfloat), (void*)0);
+    glVertexAttribPointer(texCoord_location, 2, GL_FLOAT, GL_FALSE,
+                          4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(position_location);
+    glEnableVertexAttribArray(texCoord_location);
+  }
+
+  // the element buffers stay bound inside their VAO
+  bindVertexArrayCached(0);
+  bindBufferCached(GL_ARRAY_BUFFER, 0);
+}
+
+void freeMeshes(void) {
+  for (int i = 0; i < MESH_COUNT; i++) {
+    deleteVertexArrayCached(meshes[i].vao);
+    deleteBufferCached(meshes[i].vbo);
+    deleteBufferCached(meshes[i].ebo);
+    meshes[i].vao = 0;
+    meshes[i].vbo = 0;
+    meshes[i].ebo = 0;
+    meshes[i].numIndices = 0;
+  }
+}
+
+const Mesh* getMesh(MeshId id) {
+  return &meshes[id];
+}
@@ -0,0 +1,29 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <GLES3/gl3.h>
+
+// Immutable meshes uploaded once, every sprite of the atlas is drawn on MESH_QUAD
+typedef enum {
+    MESH_QUAD,
+    MESH_COUNT
+} MeshId;
+
+typedef struct {
+    GLuint vao;             // vertex attributes and element buffer, bound once per draw
+    GLuint vbo;
+    GLuint ebo;
+    int numIndices;
+} Mesh;
+
+
+// Uploads every mesh, called once from initGraphics after the attribute
+// locations are known
+void initMeshes(void);
+
+void freeMeshes(void);
+
+const Mesh* getMesh(MeshId id);
+
+
+#endif
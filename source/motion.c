@@ -0,0 +1,91 @@
+/**
+ * Motion kernel.
+ * Same arithmetic as updatePosition, in the same order, on 4 lanes: the ship
+ * only steps (speed limit, drag) and the bullet lives are applied through
+ * lane masks built from the type array, the wrap selects between x, x - W
+ * and x + W instead of branching. Selecting rather than adding a masked
+ * offset keeps -0.0 intact, so the result matches the scalar path bit for bit.
+ */
+
+#include "motion.h"
+#include "entity.h"
+#include "simd.h"
+
+
+/* ==== KERNELS ==== */
+
+void integrateMotionScalar(EntityStore* s, int begin, int end, float dt) {
+  for (int i = begin; i < end; i++) {
+    updatePosition(s, i, s->type[i] == SHIP ? SHIP_DRAG_LOSS : 0.0f, dt);
+  }
+}
+
+#if SIMD_LANES > 1
+
+// Wraps one coordinate, hit gets the lanes that crossed an edge
+static inline vf wrap(vf p, vf* hit) {
+  vf over = vgt(p, vsplat(BOUNDARY_LIMIT));
+  vf under = vlt(p, vsplat(-BOUNDARY_LIMIT));
+  *hit = vor(*hit, vor(over, under));
+
+  vf width = vsplat(TOTAL_WIDTH);
+  return vselect(over, vsub(p, width), vselect(under, vadd(p, width), p));
+}
+
+#endif
+
+void integrateMotion(EntityStore* s, float dt) {
+  int i = 0;
+
+#if SIMD_LANES > 1
+  float ticks = dt * REFERENCE_TICK_RATE;
+  float keep = powf(1 - SHIP_DRAG_LOSS, ticks);
+
+  const vf vdt = vsplat(dt);
+  const vf vticks = vsplat(ticks);
+  const vf vkeep = vsplat(keep);
+  const vf maxSpeed = vsplat(MAX_VELOCITY);
+  const vf zero = vsplat(0.0f);
+  const vi shipType = visplat(SHIP);
+  const vi bulletType = visplat(BULLET);
+
+  for (; i + SIMD_LANES <= s->count; i += SIMD_LANES) {
+    vi type = viload(&s->type[i]);
+    vf isShip = vieq(type, shipType);
+    vf isBullet = vieq(type, bulletType);
+
+    // Update velocity based on acceleration
+    vf vx = vadd(vload(&s->vx[i]), vmul(vload(&s->ax[i]), vdt));
+    vf vy = vadd(vload(&s->vy[i]), vmul(vload(&s->ay[i]), vdt));
+
+    // Ship speed limit, the division is thrown away on the other lanes
+    vf speed = vsqrt(vadd(vmul(vx, vx), vmul(vy, vy)));
+    vf limited = vand(vgt(speed, maxSpeed), isShip);
+    vx = vselect(limited, vmul(vdiv(vx, speed), maxSpeed), vx);
+    vy = vselect(limited, vmul(vdiv(vy, speed), maxSpeed), vy);
+
+    // Update position based on velocity and wrap around the edges
+    vf hit = zero;
+    vf x = wrap(vadd(vload(&s->x[i]), vmul(vx, vticks)), &hit);
+    vf y = wrap(vadd(vload(&s->y[i]), vmul(vy, vticks)), &hit);
+
+    // A wrapping bullet loses a life, the mask lanes are -1
+    vi lives = viadd(viload(&s->lives[i]), vmaskToInt(vand(hit, isBullet)));
+
+    // Ship drag
+    vx = vselect(isShip, vmul(vx, vkeep), vx);
+    vy = vselect(isShip, vmul(vy, vkeep), vy);
+
+    vstore(&s->x[i], x);
+    vstore(&s->y[i], y);
+    vstore(&s->vx[i], vx);
+    vstore(&s->vy[i], vy);
+    vstore(&s->ax[i], zero);
+    vstore(&s->ay[i], zero);
+    vistore(&s->lives[i], lives);
+  }
+#endif
+
+  // the last count % SIMD_LANES entities
+  integrateMotionScalar(s, i, s->count, dt);
+}
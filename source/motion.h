@@ -0,0 +1,21 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "entity_store.h"
+
+// Integration of every entity of the store for one tick: velocity from
+// acceleration, the ship speed limit, position, wrap around the edges,
+// ship drag. Bullets that wrap lose a life.
+//
+// integrateMotion handles 4 entities at a time with wasm simd128 in the
+// browser (-msimd128) or SSE2 natively, the tail and the builds without
+// vector instructions go through the scalar path. Both give bit identical
+// results, bench_world checks it on every run.
+
+void integrateMotion(EntityStore* s, float dt);
+
+// Reference path, updatePosition on each entity of [begin, end)
+void integrateMotionScalar(EntityStore* s, int begin, int end, float dt);
+
+
+#endif
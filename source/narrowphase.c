@@ -0,0 +1,54 @@
+/**
+ * Narrowphase for the collisions.
+ * One bullet or the ship against the asteroids of a grid cell, read from
+ * the packed itemX/itemY/itemRadius arrays of the Grid. The wrap of the
+ * deltas is branchless, a select between d, d - W and d + W.
+ */
+
+#include "narrowphase.h"
+#include "entity.h"
+#include "simd.h"
+
+
+#if SIMD_LANES > 1
+
+static inline vf wrapDeltas(vf d) {
+  vf width = vsplat(TOTAL_WIDTH);
+  vf over = vgt(d, vsplat(BOUNDARY_LIMIT));
+  vf under = vlt(d, vsplat(-BOUNDARY_LIMIT));
+  return vselect(over, vsub(d, width), vselect(under, vadd(d, width), d));
+}
+
+#endif
+
+uint32_t collideCircles(float x, float y, float r,
+                        const float* xs, const float* ys, const float* rs, int count) {
+  uint32_t mask = 0;
+  int k = 0;
+
+#if SIMD_LANES > 1
+  const vf vx = vsplat(x);
+  const vf vy = vsplat(y);
+  const vf vr = vsplat(r);
+
+  for (; k + SIMD_LANES <= count; k += SIMD_LANES) {
+    vf dx = wrapDeltas(vsub(vx, vload(&xs[k])));
+    vf dy = wrapDeltas(vsub(vy, vload(&ys[k])));
+    vf dist2 = vadd(vmul(dx, dx), vmul(dy, dy));
+    vf sum = vadd(vr, vload(&rs[k]));
+
+    mask |= (uint32_t)vmovemask(vle(dist2, vmul(sum, sum))) << k;
+  }
+#endif
+
+  // the last count % SIMD_LANES circles
+  for (; k < count; k++) {
+    float dx = wrapDelta(x - xs[k]);
+    float dy = wrapDelta(y - ys[k]);
+    float sum = r + rs[k];
+    if (dx * dx + dy * dy <= sum * sum) {
+      mask |= 1u << k;
+    }
+  }
+  return mask;
+}
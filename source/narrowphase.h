@@ -0,0 +1,17 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include <stdint.h>
+
+// Most circles collideCircles tests in one call, one bit each
+#define NARROWPHASE_BATCH 32
+
+// Tests the circle (x, y, r) against count <= NARROWPHASE_BATCH packed
+// circles, 4 at a time with SIMD. Bit k of the result is set when it
+// touches circle k, distances are measured across the wrapped edges.
+// Same arithmetic as checkCollision, lane for lane
+uint32_t collideCircles(float x, float y, float r,
+                        const float* xs, const float* ys, const float* rs, int count);
+
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "input_queue.h"
+
+// Everything that depends on where the game runs: the browser build links
+// platform_web.c, the headless native build links platform_native.c.
+// The simulation only talks to the outside world through these functions.
+
+typedef void (*FrameCallback)(void* arg);
+
+
+// Creates the rendering context, false if it failed
+bool platformInit(void);
+
+// Starts feeding user input into the queue
+void platformHookInput(InputQueue* q);
+
+// Calls frame once per displayed frame. The browser never returns from it,
+// the headless build returns after HEADLESS_FRAMES frames
+void platformRunLoop(FrameCallback frame, void* arg);
+
+// Seed of the world: varies in the browser, fixed (HEADLESS_SEED) in the
+// headless build so two runs play the same game
+uint64_t platformSeed(void);
+
+// Monotonic time in seconds, read by the frame clock
+double platformNow(void);
+
+// Real time in seconds, for the profiler. Same as platformNow in the
+// browser, the headless build runs on a simulated clock
+double platformWallNow(void);
+
+// platformWallNow when the page or the process started: the navigation in
+// the browser, before main in the headless build. The first call must be
+// made on the main thread
+double platformStartTime(void);
+
+// Gives the CPU away for about that long, called by the simulation thread
+// between its ticks
+void platformSleep(float seconds);
+
+// Writes a file: a download in the browser, a file in the working
+// directory in the headless build. Any thread may call it: off the main
+// thread the browser build copies the data and downloads it from the main
+// thread a little later
+void platformSaveFile(const char* name, const void* data, size_t size);
+
+// Whole file in memory, read only, NULL if it cannot be read: a mapping of
+// the file in the headless build, in the browser a single copy of it out of
+// the preloaded asteroid.data. Give it back with platformUnmapFile
+const void* platformMapFile(const char* name, size_t* size);
+void platformUnmapFile(const void* data, size_t size);
+
+// Size of the surface render draws to, in device pixels. Only changes when
+// the page is resized, reading it does not query the browser
+void platformDrawableSize(int* width, int* height);
+
+
+#endif
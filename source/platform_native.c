@@ -0,0 +1,142 @@
+/**
+ * Headless native platform.
+ * No window, no GPU and no user input: the loop runs HEADLESS_FRAMES frames
+ * as fast as the CPU allows on a simulated clock, so a run always does the
+ * same amount of work and can be timed under perf, valgrind or sanitizers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+
+#include "platform.h"
+
+
+// Frames run by platformRunLoop, 10 minutes of game at 60 fps
+#ifndef HEADLESS_FRAMES
+#define HEADLESS_FRAMES 36000
+#endif
+
+// Seed of the world, a given seed always plays the same game
+#ifndef HEADLESS_SEED
+#define HEADLESS_SEED 1
+#endif
+
+// Time the simulated clock advances every frame
+#define HEADLESS_FRAME_DT (1.0 / 60.0)
+
+// Same size as the canvas of the page
+#define HEADLESS_WIDTH 1000
+#define HEADLESS_HEIGHT 1000
+
+
+// read by the simulation thread in SIM_THREAD builds
+static _Atomic double simulatedNow = 0.0;
+
+// set before main by the loader, see platformStartTime
+static double processStart = 0.0;
+
+__attribute__((constructor)) static void recordProcessStart(void) {
+  processStart = platformWallNow();
+}
+
+
+bool platformInit(void) {
+  simulatedNow = 0.0;
+  return true;
+}
+
+void platformHookInput(InputQueue* q) {
+  // nothing ever types in a headless run
+  (void)q;
+}
+
+void platformRunLoop(FrameCallback frame, void* arg) {
+  double start = platformWallNow();
+
+  for (int f = 0; f < HEADLESS_FRAMES; f++) {
+    atomic_store(&simulatedNow, atomic_load(&simulatedNow) + HEADLESS_FRAME_DT);
+    frame(arg);
+
+#ifdef SIM_THREAD
+    // give the simulation thread its turn on the new simulated time
+    sched_yield();
+#endif
+  }
+
+  double elapsed = platformWallNow() - start;
+  printf("headless   %d frames in %.3f s   %.2f us per frame\n",
+         HEADLESS_FRAMES, elapsed, elapsed * 1e6 / HEADLESS_FRAMES);
+}
+
+uint64_t platformSeed(void) {
+  return HEADLESS_SEED;
+}
+
+double platformNow(void) {
+  return atomic_load(&simulatedNow);
+}
+
+double platformWallNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+double platformStartTime(void) {
+  return processStart;
+}
+
+void platformSleep(float seconds) {
+  // the clock is simulated, only the render loop makes it move
+  (void)seconds;
+  sched_yield();
+}
+
+void platformSaveFile(const char* name, const void* data, size_t size) {
+  FILE* f = fopen(name, "wb");
+  if (!f) {
+    printf("Failed to open %s for writing\n", name);
+    return;
+  }
+  if (fwrite(data, 1, size, f) != size) {
+    printf("Failed to write %s\n", name);
+  }
+  fclose(f);
+}
+
+const void* platformMapFile(const char* name, size_t* size) {
+  int fd = open(name, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // the mapping outlives the descriptor
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  return data;
+}
+
+void platformUnmapFile(const void* data, size_t size) {
+  munmap((void*)data, size);
+}
+
+void platformDrawableSize(int* width, int* height) {
+  *width = HEADLESS_WIDTH;
+  *height = HEADLESS_HEIGHT;
+}
@@ -0,0 +1,211 @@
+/**
+ * Browser platform.
+ * WebGL2 context on #canvas, keyboard callbacks, the requestAnimationFrame
+ * loop and the file download, everything Emscripten specific lives here.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <emscripten.h>
+#include <emscripten/html5.h>
+#include <emscripten/threading.h>
+
+#include "platform.h"
+#include "controls.h"
+
+
+static EMSCRIPTEN_WEBGL_CONTEXT_HANDLE context = 0;
+
+// canvas size in device pixels, set on resize
+static int drawableWidth = 1000;
+static int drawableHeight = 1000;
+
+
+// Sizes the canvas backing store to its CSS size times devicePixelRatio,
+// so the frame is presented 1:1 on high density screens
+static void fitCanvas(void) {
+  double cssWidth, cssHeight;
+  if (emscripten_get_element_css_size("#canvas", &cssWidth, &cssHeight) != EMSCRIPTEN_RESULT_SUCCESS) {
+    return;
+  }
+
+  double ratio = emscripten_get_device_pixel_ratio();
+  int width = (int)(cssWidth * ratio + 0.5);
+  int height = (int)(cssHeight * ratio + 0.5);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  if (width != drawableWidth || height != drawableHeight) {
+    emscripten_set_canvas_element_size("#canvas", width, height);
+  }
+  drawableWidth = width;
+  drawableHeight = height;
+}
+
+static EM_BOOL onResize(int eventType, const EmscriptenUiEvent* event, void* userData) {
+  (void)eventType;
+  (void)event;
+  (void)userData;
+  fitCanvas();
+  return EM_FALSE;
+}
+
+
+bool platformInit(void) {
+  //  WebGL context attributes
+  EmscriptenWebGLContextAttributes attr;
+  emscripten_webgl_init_context_attributes(&attr);
+  // no depth and no MSAA on the canvas, the frame is drawn offscreen with
+  // its own samples and only blitted here (render_target.c)
+  attr.alpha = EM_TRUE;
+  attr.depth = EM_FALSE;
+  attr.stencil = EM_FALSE;
+  attr.antialias = EM_FALSE;
+  attr.majorVersion = 2;
+
+  // WebGL context
+  context = emscripten_webgl_create_context("#canvas", &attr);
+  if (context <= 0) {
+    printf("Failed to create WebGL context\n");
+    return false;
+  }
+
+  // Make the context current
+  emscripten_webgl_make_context_current(context);
+
+  // the drawable size follows the page, zooming also changes the ratio
+  fitCanvas();
+  emscripten_set_resize_callback(EMSCRIPTEN_EVENT_TARGET_WINDOW, NULL, EM_FALSE, onResize);
+  return true;
+}
+
+void platformHookInput(InputQueue* q) {
+  handleInput(q);
+}
+
+void platformRunLoop(FrameCallback frame, void* arg) {
+  emscripten_set_main_loop_arg(frame, arg, 0, 1);
+}
+
+uint64_t platformSeed(void) {
+  // page time mixed with the wall clock, a new game on every load
+  return (uint64_t)emscripten_get_now() ^ ((uint64_t)time(NULL) << 20);
+}
+
+double platformNow(void) {
+  // performance.now, sub-millisecond
+  return emscripten_get_now() / 1000.0;
+}
+
+double platformWallNow(void) {
+  return platformNow();
+}
+
+double platformStartTime(void) {
+  // performance.now counts from the navigation on the main thread, but
+  // emscripten_get_now adds performance.timeOrigin in pthread builds so
+  // that workers agree: the origin is the gap between the two, taken once.
+  // main asks first, on the main thread
+  static double origin = 0.0;
+  static bool known = false;
+  if (!known) {
+    origin = (emscripten_get_now() - emscripten_performance_now()) / 1000.0;
+    known = true;
+  }
+  return origin;
+}
+
+void platformSleep(float seconds) {
+  // only ever called from the simulation pthread, never on the main thread
+  if (seconds > 0.0f) {
+    emscripten_thread_sleep(seconds * 1000.0);
+  }
+}
+
+EM_JS(void, downloadFile, (const char* name, const void* data, int size), {
+  const bytes = HEAPU8.slice(data, data + size);
+  const link = document.createElement('a');
+  link.href = URL.createObjectURL(new Blob([bytes]));
+  link.download = UTF8ToString(name);
+  link.click();
+  URL.revokeObjectURL(link.href);
+});
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+// A file handed to the main thread, name and bytes follow in the same block
+typedef struct {
+    const char* name;
+    const unsigned char* data;
+    size_t size;
+} PendingSave;
+
+static void saveOnMainThread(void* arg) {
+  PendingSave* save = arg;
+  downloadFile(save->name, save->data, (int)save->size);
+  free(save);
+}
+#endif
+
+void platformSaveFile(const char* name, const void* data, size_t size) {
+#ifdef __EMSCRIPTEN_PTHREADS__
+  // a worker has no document to download from, the main thread saves a
+  // copy so the caller can keep using its buffer
+  if (!emscripten_is_main_runtime_thread()) {
+    size_t nameSize = strlen(name) + 1;
+    PendingSave* save = malloc(sizeof(PendingSave) + nameSize + size);
+    if (!save) {
+      printf("Failed to save %s, out of memory\n", name);
+      return;
+    }
+    char* nameCopy = (char*)(save + 1);
+    unsigned char* dataCopy = (unsigned char*)nameCopy + nameSize;
+    memcpy(nameCopy, name, nameSize);
+    memcpy(dataCopy, data, size);
+    save->name = nameCopy;
+    save->data = dataCopy;
+    save->size = size;
+    emscripten_async_run_in_main_runtime_thread(EM_FUNC_SIG_VI, saveOnMainThread, save);
+    return;
+  }
+#endif
+  downloadFile(name, data, (int)size);
+}
+
+const void* platformMapFile(const char* name, size_t* size) {
+  // the file sits in MEMFS, preloaded with asteroid.data: one read copies
+  // it to the heap and nothing else touches it after
+  FILE* f = fopen(name, "rb");
+  if (!f) {
+    return NULL;
+  }
+
+  void* data = NULL;
+  long length = 0;
+  if (fseek(f, 0, SEEK_END) == 0 && (length = ftell(f)) > 0 &&
+      fseek(f, 0, SEEK_SET) == 0) {
+    data = malloc((size_t)length);
+  }
+  if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+
+  if (data) {
+    *size = (size_t)length;
+  }
+  return data;
+}
+
+void platformUnmapFile(const void* data, size_t size) {
+  (void)size;
+  free((void*)data);
+}
+
+void platformDrawableSize(int* width, int* height) {
+  *width = drawableWidth;
+  *height = drawableHeight;
+}
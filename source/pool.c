@@ -0,0 +1,86 @@
+/**
+ * Free-list pool allocator.
+ * The free indices are kept on a stack that starts with slot 0 on top, and a
+ * released slot is the next one handed out. This way the live items stay
+ * packed at the beginning of the block instead of being spread over the heap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "pool.h"
+
+
+bool initPool(Pool* p, size_t itemSize, int capacity) {
+  p->items = malloc(itemSize * capacity);
+  p->freeList = malloc(sizeof(int) * capacity);
+  if (!p->items || !p->freeList) {
+    printf("ERROR: Out of memory when creating a pool of %d items\n", capacity);
+    free(p->items);
+    free(p->freeList);
+    p->items = NULL;
+    p->freeList = NULL;
+    return false;
+  }
+
+  p->itemSize = itemSize;
+  p->capacity = capacity;
+  p->highWater = 0;
+  p->failed = 0;
+  resetPool(p);
+
+  return true;
+}
+
+void freePool(Pool* p) {
+  free(p->items);
+  free(p->freeList);
+  p->items = NULL;
+  p->freeList = NULL;
+  p->capacity = 0;
+  p->freeTop = 0;
+  p->used = 0;
+}
+
+void resetPool(Pool* p) {
+  // lowest index on top of the stack
+  for (int i = 0; i < p->capacity; i++) {
+    p->freeList[i] = p->capacity - 1 - i;
+  }
+  p->freeTop = p->capacity;
+  p->used = 0;
+}
+
+void* poolAcquire(Pool* p) {
+  if (p->freeTop == 0) {
+    p->failed++;
+    return NULL;
+  }
+
+  int slot = p->freeList[--p->freeTop];
+
+  p->used++;
+  if (p->used > p->highWater) {
+    p->highWater = p->used;
+  }
+
+  return p->items + (size_t)slot * p->itemSize;
+}
+
+void poolRelease(Pool* p, void* item) {
+  if (!item) return;
+
+  int slot = (int)(((unsigned char*)item - p->items) / p->itemSize);
+  if (slot < 0 || slot >= p->capacity) {
+    printf("ERROR: releasing an item that does not belong to the pool\n");
+    return;
+  }
+
+  p->freeList[p->freeTop++] = slot;
+  p->used--;
+}
+
+void printPoolStats(const char* name, const Pool* p) {
+  printf("%-10s used %3d / %3d   high water %3d   refused %d\n",
+         name, p->used, p->capacity, p->highWater, p->failed);
+}
@@ -0,0 +1,40 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+// Fixed-capacity pool of equally sized items.
+// All the storage is allocated once in initPool, acquire and release are O(1).
+typedef struct {
+    unsigned char* items;   // contiguous storage, capacity * itemSize bytes
+    int* freeList;          // stack of free slot indices
+    int freeTop;            // number of indices currently on the free stack
+    size_t itemSize;
+    int capacity;
+
+    // occupancy counters
+    int used;               // slots currently handed out
+    int highWater;          // maximum value reached by used
+    int failed;             // acquires refused because the pool was full
+} Pool;
+
+
+// Allocates the storage, returns false if we are out of memory
+bool initPool(Pool* p, size_t itemSize, int capacity);
+
+void freePool(Pool* p);
+
+// returns NULL when every slot is in use
+void* poolAcquire(Pool* p);
+
+void poolRelease(Pool* p, void* item);
+
+// Gives back every slot at once (counters other than used are kept)
+void resetPool(Pool* p);
+
+void printPoolStats(const char* name, const Pool* p);
+
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * Hot path profiler.
+ * The ring is a static array, recording an event is a clock read and an
+ * atomic increment, nothing is allocated until the dump. Events of the
+ * simulation thread and of the main thread share the ring, each thread gets
+ * its own tid in the trace.
+ */
+
+#include "profiler.h"
+
+#ifdef PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "platform.h"
+
+
+#define PROFILE_MASK (PROFILE_CAPACITY - 1)
+
+// Longest line of the trace, with the name
+#define EVENT_JSON_SIZE 160
+
+typedef struct {
+    const char* name;
+    double start;           // microseconds
+    double end;
+    uint32_t thread;
+} ProfileEvent;
+
+
+static ProfileEvent events[PROFILE_CAPACITY];
+static _Atomic uint32_t written = 0;
+
+// 0 until the thread records its first event
+static _Thread_local uint32_t threadId = 0;
+static _Atomic uint32_t threadCount = 0;
+
+
+double profileNow(void) {
+  return platformWallNow() * 1e6;
+}
+
+void profileRecord(const char* name, double startUs, double endUs) {
+  if (threadId == 0) {
+    threadId = atomic_fetch_add(&threadCount, 1) + 1;
+  }
+
+  // past PROFILE_CAPACITY the oldest events are overwritten
+  uint32_t i = atomic_fetch_add_explicit(&written, 1, memory_order_relaxed);
+  ProfileEvent* e = &events[i & PROFILE_MASK];
+  e->name = name;
+  e->start = startUs;
+  e->end = endUs;
+  e->thread = threadId;
+}
+
+void profileDump(const char* file) {
+  uint32_t end = atomic_load(&written);
+  uint32_t begin = end > PROFILE_CAPACITY ? end - PROFILE_CAPACITY : 0;
+
+  size_t capacity = (size_t)(end - begin) * EVENT_JSON_SIZE + 64;
+  char* json = malloc(capacity);
+  if (!json) {
+    printf("ERROR: Out of memory in function profileDump\n");
+    return;
+  }
+
+  size_t size = (size_t)snprintf(json, capacity, "{\"traceEvents\":[\n");
+  for (uint32_t i = begin; i < end; i++) {
+    const ProfileEvent* e = &events[i & PROFILE_MASK];
+    size += (size_t)snprintf(json + size, capacity - size,
+                             "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                             "\"pid\":1,\"tid\":%u}\n",
+                             i == begin ? "" : ",", e->name, e->start,
+                             e->end - e->start, e->thread);
+  }
+  size += (size_t)snprintf(json + size, capacity - size, "],\"displayTimeUnit\":\"ms\"}\n");
+
+  platformSaveFile(file, json, size);
+  printf("profile    %u events written to %s\n", end - begin, file);
+  free(json);
+}
+
+#endif
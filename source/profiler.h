@@ -0,0 +1,46 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped timers for the hot paths, built with -DPROFILE (make PROFILE=1).
+// Without it every macro expands to nothing and profiler.c is empty.
+//
+//   PROFILE_BEGIN(collisionDetection);
+//   collisionDetection(w);
+//   PROFILE_END(collisionDetection);
+//
+// Begin and end of a pair take the same name and must be in the same scope.
+// Events go to a preallocated ring that keeps the last PROFILE_CAPACITY
+// of them, PROFILE_DUMP writes the ring as Chrome Trace Event JSON (open it
+// in chrome://tracing or ui.perfetto.dev) through platformSaveFile.
+
+// Trace written at the end of a headless run, and by the P key in the browser
+#define PROFILE_FILE "asteroid.trace.json"
+
+#ifdef PROFILE
+
+// Events kept by the ring, a power of two
+#define PROFILE_CAPACITY 65536
+
+#define PROFILE_BEGIN(name) double profileStart_##name = profileNow()
+#define PROFILE_END(name) profileRecord(#name, profileStart_##name, profileNow())
+#define PROFILE_DUMP(file) profileDump(file)
+
+// Wall clock in microseconds
+double profileNow(void);
+
+// name must outlive the program, the macros pass string literals
+void profileRecord(const char* name, double startUs, double endUs);
+
+// Oldest event first. Events recorded while it runs may be missed
+void profileDump(const char* file);
+
+#else
+
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END(name) ((void)0)
+#define PROFILE_DUMP(file) ((void)0)
+
+#endif
+
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * Render list.
+ * Turns a world snapshot into sprite instances: interpolation, world to NDC
+ * and atlas lookup. Only plain memory is written here, the upload is done by
+ * the sprite batch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "render_list.h"
+#include "entity.h"
+
+
+// Half size of each sprite, in the same units as the old per archetype meshes
+static const float spriteHalfSize[SPRITE_COUNT] = {
+  [SPRITE_SHIP]      = SHIP_HALF_SIZE,
+  [SPRITE_BULLET]    = BULLET_HALF_SIZE,
+  [SPRITE_ASTEROID0] = ASTEROID0_HALF_SIZE,
+  [SPRITE_ASTEROID1] = ASTEROID1_HALF_SIZE,
+  [SPRITE_ASTEROID2] = ASTEROID2_HALF_SIZE,
+};
+
+
+void initRenderList(RenderList* list) {
+  list->data = NULL;
+  list->count = 0;
+  list->capacity = 0;
+}
+
+void freeRenderList(RenderList* list) {
+  free(list->data);
+  initRenderList(list);
+}
+
+void clearRenderList(RenderList* list) {
+  list->count = 0;
+}
+
+// Grows the instance array, only happens when the world gets bigger
+static bool reserveSprites(RenderList* list, int count) {
+  if (count <= list->capacity) {
+    return true;
+  }
+
+  int capacity = list->capacity > 0 ? list->capacity : 256;
+  while (capacity < count) {
+    capacity *= 2;
+  }
+
+  float* data = realloc(list->data, sizeof(float) * INSTANCE_FLOATS * capacity);
+  if (!data) {
+    printf("ERROR: Out of memory when growing the render list\n");
+    return false;
+  }
+  list->data = data;
+  list->capacity = capacity;
+  return true;
+}
+
+bool pushSprite(RenderList* list, SpriteId sprite, float x, float y, float angle,
+                float halfWidth, float halfHeight) {
+  if (!reserveSprites(list, list->count + 1)) {
+    return false;
+  }
+
+  float* inst = &list->data[INSTANCE_FLOATS * list->count++];
+  inst[0] = x;
+  inst[1] = y;
+  inst[2] = angle;
+  inst[3] = halfWidth;
+  inst[4] = halfHeight;
+  inst[5] = atlasRects[sprite][0];
+  inst[6] = atlasRects[sprite][1];
+  inst[7] = atlasRects[sprite][2];
+  inst[8] = atlasRects[sprite][3];
+  return true;
+}
+
+void appendRenderList(RenderList* list, const RenderList* src) {
+  if (!reserveSprites(list, list->count + src->count)) {
+    return;
+  }
+
+  memcpy(&list->data[INSTANCE_FLOATS * list->count], src->data,
+         sizeof(float) * INSTANCE_FLOATS * src->count);
+  list->count += src->count;
+}
+
+void buildRenderList(RenderList* list, const WorldSnapshot* s, float alpha,
+                     int width, int height) {
+  if (!reserveSprites(list, list->count + s->count)) {
+    return;
+  }
+
+  // Entities are drawn between the last two ticks, alpha of the way
+  for (int i = 0; i < s->count; i++) {
+    float x = s->x[i];
+    float y = s->y[i];
+    float dx = x - s->prevX[i];
+    float dy = y - s->prevY[i];
+
+    // no interpolation across the world edge, the entity just wrapped
+    if (fabsf(dx) < BOUNDARY_LIMIT && fabsf(dy) < BOUNDARY_LIMIT) {
+      x = s->prevX[i] + dx * alpha;
+      y = s->prevY[i] + dy * alpha;
+    }
+    float a = s->prevAngle[i] + (s->angle[i] - s->prevAngle[i]) * alpha;
+
+    float size = spriteHalfSize[s->sprite[i]];
+    pushSprite(list, s->sprite[i],
+               x / (float)width,
+               y / (float)height,
+               a,
+               size, size);
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef RENDER_LIST_H
+#define RENDER_LIST_H
+
+#include <stdbool.h>
+#include "atlas.h"
+#include "snapshot.h"
+
+// Size the world and the HUD are laid out for, the canvas size of the page.
+// The drawable can be any size, the frame is stretched over it
+#define LAYOUT_WIDTH 1000
+#define LAYOUT_HEIGHT 1000
+
+// Per instance data: translation x,y, angle, half size x,y, uv rect
+#define INSTANCE_FLOATS 9
+
+// CPU side list of the sprites of one frame, in the layout the sprite batch
+// uploads. It does not touch GL so it also runs in the headless build.
+typedef struct {
+    float* data;            // INSTANCE_FLOATS per sprite
+    int count;
+    int capacity;           // in sprites, only grows
+} RenderList;
+
+
+void initRenderList(RenderList* list);
+void freeRenderList(RenderList* list);
+
+void clearRenderList(RenderList* list);
+
+// Position and half size in normalised device coordinates
+bool pushSprite(RenderList* list, SpriteId sprite, float x, float y, float angle,
+                float halfWidth, float halfHeight);
+
+// Appends every sprite of src
+void appendRenderList(RenderList* list, const RenderList* src);
+
+// Appends every entity of the snapshot, interpolated alpha of the way between
+// its last two ticks, for a width x height drawable
+void buildRenderList(RenderList* list, const WorldSnapshot* snap, float alpha,
+                     int width, int height);
+
+
+#endif
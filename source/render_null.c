@@ -0,0 +1,69 @@
+/**
+ * Null renderer for the headless build.
+ * Nothing is drawn, the render list is still built every frame so the CPU
+ * side of a frame costs the same as in the browser.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "renderer.h"
+#include "render_list.h"
+#include "platform.h"
+#include "hud.h"
+#include "asset_loader.h"
+#include "startup.h"
+#include "profiler.h"
+
+
+// print the stats every RENDER_STATS_PERIOD frames, like graphics.c
+#define RENDER_STATS_PERIOD 600
+static int frameCount = 0;
+
+static RenderList frameList;
+static Hud hud;
+
+// same loading phase as graphics.c, without the uploads
+static AssetLoader loader;
+static bool loading = true;
+
+
+void initGraphics(void) {
+  frameCount = 0;
+  startAssetLoad(&loader, ASSET_BUNDLE_PATH);
+
+  initRenderList(&frameList);
+  initHud(&hud);
+}
+
+void render(const WorldSnapshot* snap) {
+  if (loading) {
+    if (!assetsRead(&loader)) {
+      return;
+    }
+    if (loader.ok) {
+      const BundleEntry* atlas = findAsset(&loader.bundle, ATLAS_ASSET);
+      printf("assets     %d in %s   atlas %s\n", loader.bundle.count, ASSET_BUNDLE_PATH,
+             atlas ? "found" : "missing");
+    }
+    finishAssetLoad(&loader);
+    loading = false;
+  }
+
+  clearRenderList(&frameList);
+  buildRenderList(&frameList, snap, snapshotAlpha(snap, platformNow()),
+                  LAYOUT_WIDTH, LAYOUT_HEIGHT);
+
+  // the text is only printed when the glyphs are laid out again
+  PROFILE_BEGIN(updateHud);
+  if (updateHud(&hud, snap->score, snap->lives, LAYOUT_WIDTH, LAYOUT_HEIGHT)) {
+    printf("Score: %d   Lives: %d\n", snap->score, snap->lives);
+  }
+  drawHud(&hud, &frameList);
+  PROFILE_END(updateHud);
+  startupFrameDrawn();
+
+  if (++frameCount % RENDER_STATS_PERIOD == 0) {
+    printf("render     sprites %d   (null renderer)\n", frameList.count);
+  }
+}
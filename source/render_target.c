@@ -0,0 +1,135 @@
+/**
+ * Offscreen render target.
+ * Color renderbuffers only, nothing samples them: the MSAA resolve and the
+ * upscale are both glBlitFramebuffer. A multisampled blit must keep its
+ * size, so with MSAA the frame is first resolved at its own size and then
+ * scaled to the canvas with a linear filter.
+ */
+
+#include <stdio.h>
+
+#include "render_target.h"
+#include "gl_state.h"
+
+
+void initRenderTarget(RenderTarget* t) {
+  t->width = 0;
+  t->height = 0;
+  t->samples = 0;
+  t->direct = true;
+  t->fbo = 0;
+  t->color = 0;
+  t->msaaFbo = 0;
+  t->msaaColor = 0;
+  t->failedWidth = 0;
+  t->failedHeight = 0;
+  t->failedSamples = 0;
+}
+
+// Back to drawing straight to the canvas, the failed request is kept
+static void releaseBuffers(RenderTarget* t) {
+  if (t->fbo) deleteFramebufferCached(t->fbo);
+  if (t->msaaFbo) deleteFramebufferCached(t->msaaFbo);
+  if (t->color) glDeleteRenderbuffers(1, &t->color);
+  if (t->msaaColor) glDeleteRenderbuffers(1, &t->msaaColor);
+  t->width = 0;
+  t->height = 0;
+  t->samples = 0;
+  t->direct = true;
+  t->fbo = 0;
+  t->color = 0;
+  t->msaaFbo = 0;
+  t->msaaColor = 0;
+}
+
+void freeRenderTarget(RenderTarget* t) {
+  releaseBuffers(t);
+  initRenderTarget(t);
+}
+
+// Framebuffer with one color renderbuffer, false if incomplete
+static bool createFramebuffer(GLuint* fbo, GLuint* color, int width, int height, int samples) {
+  glGenRenderbuffers(1, color);
+  glBindRenderbuffer(GL_RENDERBUFFER, *color);
+  if (samples > 0) {
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+  } else {
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  }
+
+  glGenFramebuffers(1, fbo);
+  bindFramebufferCached(GL_FRAMEBUFFER, *fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, *color);
+
+  return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+bool resizeRenderTarget(RenderTarget* t, int width, int height, int samples,
+                        int canvasWidth, int canvasHeight) {
+  if (width == t->failedWidth && height == t->failedHeight && samples == t->failedSamples) {
+    return false;
+  }
+
+  bool direct = samples == 0 && width == canvasWidth && height == canvasHeight;
+  if (width == t->width && height == t->height && samples == t->samples && direct == t->direct) {
+    return true;
+  }
+
+  releaseBuffers(t);
+  t->width = width;
+  t->height = height;
+  t->samples = samples;
+  t->direct = direct;
+  if (direct) {
+    return true;
+  }
+
+  bool ok = createFramebuffer(&t->fbo, &t->color, width, height, 0);
+  if (ok && samples > 0) {
+    ok = createFramebuffer(&t->msaaFbo, &t->msaaColor, width, height, samples);
+  }
+  bindFramebufferCached(GL_FRAMEBUFFER, 0);
+
+  if (!ok) {
+    printf("Error creating a %dx%d render target with %d samples in function resizeRenderTarget\n",
+           width, height, samples);
+    releaseBuffers(t);
+    t->width = canvasWidth;
+    t->height = canvasHeight;
+    t->failedWidth = width;
+    t->failedHeight = height;
+    t->failedSamples = samples;
+    return false;
+  }
+  return true;
+}
+
+void bindRenderTarget(const RenderTarget* t) {
+  if (t->direct) {
+    bindFramebufferCached(GL_DRAW_FRAMEBUFFER, 0);
+  } else {
+    bindFramebufferCached(GL_DRAW_FRAMEBUFFER, t->samples > 0 ? t->msaaFbo : t->fbo);
+  }
+}
+
+void presentRenderTarget(const RenderTarget* t, int canvasWidth, int canvasHeight) {
+  if (t->direct) {
+    return;
+  }
+
+  // 1) MSAA resolve, same size on both sides
+  if (t->samples > 0) {
+    bindFramebufferCached(GL_READ_FRAMEBUFFER, t->msaaFbo);
+    bindFramebufferCached(GL_DRAW_FRAMEBUFFER, t->fbo);
+    glBlitFramebuffer(0, 0, t->width, t->height, 0, 0, t->width, t->height,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    countGlCall();
+  }
+
+  // 2) Upscale to the canvas
+  bindFramebufferCached(GL_READ_FRAMEBUFFER, t->fbo);
+  bindFramebufferCached(GL_DRAW_FRAMEBUFFER, 0);
+  glBlitFramebuffer(0, 0, t->width, t->height, 0, 0, canvasWidth, canvasHeight,
+                    GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  countGlCall();
+}
@@ -0,0 +1,43 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <stdbool.h>
+#include <GLES3/gl3.h>
+
+// Offscreen framebuffer the frame is drawn into, then resolved and scaled
+// up to the canvas. At the canvas size without MSAA the frame is drawn
+// straight to the canvas instead.
+typedef struct {
+    int width;
+    int height;
+    int samples;            // 0 without MSAA
+    bool direct;            // drawing to the default framebuffer
+
+    GLuint fbo;             // single sampled, blitted to the canvas
+    GLuint color;
+    GLuint msaaFbo;         // drawn into when samples > 0, resolved to fbo
+    GLuint msaaColor;
+
+    int failedWidth;        // last size and samples the GPU refused, not
+    int failedHeight;       // asked for again
+    int failedSamples;
+} RenderTarget;
+
+
+void initRenderTarget(RenderTarget* t);
+void freeRenderTarget(RenderTarget* t);
+
+// Reallocates the buffers, only when the size or the samples changed.
+// False if the GPU refused them, the frame then goes straight to the canvas
+// at its size without MSAA, and the same request fails again at no cost
+bool resizeRenderTarget(RenderTarget* t, int width, int height, int samples,
+                        int canvasWidth, int canvasHeight);
+
+// Binds the framebuffer the frame is drawn into
+void bindRenderTarget(const RenderTarget* t);
+
+// Resolves the MSAA samples and scales the frame up to the canvas
+void presentRenderTarget(const RenderTarget* t, int canvasWidth, int canvasHeight);
+
+
+#endif
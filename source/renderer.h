@@ -0,0 +1,17 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "snapshot.h"
+
+// What main needs from a renderer. graphics.c draws with WebGL2,
+// render_null.c is linked in the headless build.
+
+// Initializes global shader state (only done once)
+void initGraphics(void);
+
+// Draws a snapshot interpolated between its last two ticks. It never
+// touches the World, the simulation may be running on another thread
+void render(const WorldSnapshot* snap);
+
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * Input recording and replay.
+ * Commands are appended to a memory buffer as (tick delta, command) pairs,
+ * most ticks have no command so a session weighs a few bytes per key press.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "platform.h"
+
+
+/* =========================== RECORDING =========================== */
+
+static bool reserveBytes(Recorder* r, size_t extra) {
+  if (r->size + extra <= r->capacity) {
+    return true;
+  }
+
+  size_t capacity = r->capacity > 0 ? r->capacity : 4096;
+  while (capacity < r->size + extra) {
+    capacity *= 2;
+  }
+
+  unsigned char* data = realloc(r->data, capacity);
+  if (!data) {
+    printf("ERROR: Out of memory when growing the recording\n");
+    return false;
+  }
+  r->data = data;
+  r->capacity = capacity;
+  return true;
+}
+
+static void putByte(Recorder* r, unsigned char b) {
+  if (reserveBytes(r, 1)) {
+    r->data[r->size++] = b;
+  }
+}
+
+static void putVarint(Recorder* r, uint32_t v) {
+  while (v >= 0x80) {
+    putByte(r, (unsigned char)(v | 0x80));
+    v >>= 7;
+  }
+  putByte(r, (unsigned char)v);
+}
+
+bool startRecording(Recorder* r, uint64_t seed, float tickRate) {
+  r->data = NULL;
+  r->size = 0;
+  r->capacity = 0;
+  r->lastTick = 0;
+  r->commands = 0;
+
+  if (!reserveBytes(r, REPLAY_HEADER_SIZE)) {
+    return false;
+  }
+
+  memcpy(r->data, REPLAY_MAGIC, 4);
+  r->size = 4;
+  putByte(r, REPLAY_VERSION);
+  for (int i = 0; i < 8; i++) {
+    putByte(r, (unsigned char)(seed >> (8 * i)));
+  }
+
+  uint32_t rateBits;
+  memcpy(&rateBits, &tickRate, sizeof(rateBits));
+  for (int i = 0; i < 4; i++) {
+    putByte(r, (unsigned char)(rateBits >> (8 * i)));
+  }
+  return true;
+}
+
+void freeRecording(Recorder* r) {
+  free(r->data);
+  r->data = NULL;
+  r->size = 0;
+  r->capacity = 0;
+}
+
+void recordCommand(Recorder* r, uint32_t tick, Command command) {
+  putVarint(r, tick - r->lastTick);
+  putByte(r, (unsigned char)command);
+  r->lastTick = tick;
+  r->commands++;
+}
+
+void saveRecording(Recorder* r, uint32_t tick) {
+  // the end record is only there for the saved copy
+  size_t size = r->size;
+  putVarint(r, tick - r->lastTick);
+  putByte(r, REPLAY_END);
+
+  platformSaveFile(REPLAY_FILE, r->data, r->size);
+  printf("Recording saved: %d commands over %u ticks, %zu bytes\n",
+         r->commands, tick, r->size);
+
+  r->size = size;
+}
+
+
+/* ============================ REPLAY ============================= */
+
+static bool getVarint(Replay* p, uint32_t* v) {
+  uint32_t value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (p->pos >= p->size) {
+      return false;
+    }
+    unsigned char b = p->data[p->pos++];
+    value |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *v = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads the record at pos into nextTick / nextCommand
+static void readRecord(Replay* p) {
+  uint32_t delta;
+  if (!getVarint(p, &delta) || p->pos >= p->size) {
+    printf("ERROR: Truncated replay, stopping at tick %u\n", p->nextTick);
+    p->nextCommand = REPLAY_END;
+    p->endTick = p->nextTick;
+    return;
+  }
+
+  p->nextTick += delta;
+  p->nextCommand = p->data[p->pos++];
+  if (p->nextCommand != REPLAY_END && p->nextCommand >= CMD_COUNT) {
+    printf("ERROR: Unknown command %d in replay, stopping at tick %u\n",
+           p->nextCommand, p->nextTick);
+    p->nextCommand = REPLAY_END;
+  }
+  if (p->nextCommand == REPLAY_END) {
+    p->endTick = p->nextTick;
+  }
+}
+
+bool loadReplay(Replay* p, const char* path) {
+  memset(p, 0, sizeof(*p));
+
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    printf("Failed to open replay %s\n", path);
+    return false;
+  }
+
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  if (size < REPLAY_HEADER_SIZE) {
+    printf("ERROR: %s is too small to be a replay\n", path);
+    fclose(f);
+    return false;
+  }
+
+  p->data = malloc(size);
+  if (!p->data || fread(p->data, 1, size, f) != (size_t)size) {
+    printf("Failed to read replay %s\n", path);
+    fclose(f);
+    freeReplay(p);
+    return false;
+  }
+  fclose(f);
+  p->size = size;
+
+  if (memcmp(p->data, REPLAY_MAGIC, 4) != 0 || p->data[4] != REPLAY_VERSION) {
+    printf("ERROR: %s is not a version %d replay\n", path, REPLAY_VERSION);
+    freeReplay(p);
+    return false;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    p->seed |= (uint64_t)p->data[5 + i] << (8 * i);
+  }
+  uint32_t rateBits = 0;
+  for (int i = 0; i < 4; i++) {
+    rateBits |= (uint32_t)p->data[13 + i] << (8 * i);
+  }
+  memcpy(&p->tickRate, &rateBits, sizeof(rateBits));
+
+  p->pos = REPLAY_HEADER_SIZE;
+  p->nextTick = 0;
+  readRecord(p);
+  return true;
+}
+
+void freeReplay(Replay* p) {
+  free(p->data);
+  p->data = NULL;
+  p->size = 0;
+}
+
+bool nextReplayCommand(Replay* p, uint32_t tick, Command* command) {
+  if (p->nextCommand == REPLAY_END || p->nextTick != tick) {
+    return false;
+  }
+
+  *command = (Command)p->nextCommand;
+  readRecord(p);
+  return true;
+}
+
+bool replayFinished(const Replay* p, uint32_t tick) {
+  return p->nextCommand == REPLAY_END && tick >= p->endTick;
+}
@@ -0,0 +1,62 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "entity.h"
+
+// Input recordings. A recording is the seed of the world plus every command
+// with the tick it was applied on, replaying it plays the same game.
+//
+// File layout, little endian:
+//   "ASTR" version:u8 seed:u64 tickRate:f32
+//   then per command: tickDelta:varint command:u8
+//   and an end record: tickDelta:varint REPLAY_END, the delta reaching the
+//   last simulated tick
+#define REPLAY_MAGIC "ASTR"
+#define REPLAY_VERSION 1
+#define REPLAY_END 0xFF
+#define REPLAY_HEADER_SIZE 17
+
+// Default file name of a recording
+#define REPLAY_FILE "asteroid.replay"
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    uint32_t lastTick;      // tick of the last record written
+    int commands;
+} Recorder;
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t pos;             // next record to read
+    uint64_t seed;
+    float tickRate;
+    uint32_t nextTick;      // tick of the command at pos
+    int nextCommand;        // REPLAY_END once everything was read
+    uint32_t endTick;       // valid once nextCommand is REPLAY_END
+} Replay;
+
+
+bool startRecording(Recorder* r, uint64_t seed, float tickRate);
+void freeRecording(Recorder* r);
+
+void recordCommand(Recorder* r, uint32_t tick, Command command);
+
+// Writes the recording so far, up to tick, through the platform layer.
+// Recording goes on afterwards
+void saveRecording(Recorder* r, uint32_t tick);
+
+bool loadReplay(Replay* p, const char* path);
+void freeReplay(Replay* p);
+
+// Next command due on tick, false when none is left for it
+bool nextReplayCommand(Replay* p, uint32_t tick, Command* command);
+
+bool replayFinished(const Replay* p, uint32_t tick);
+
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * Seeded random numbers.
+ * xoshiro128** by Blackman and Vigna: four words of state, a handful of
+ * shifts and rotates per number and 32 bit only, which suits wasm.
+ */
+
+#include "rng.h"
+
+
+static uint64_t splitmix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint32_t rotl(uint32_t x, int k) {
+  return (x << k) | (x >> (32 - k));
+}
+
+void seedRng(Rng* r, uint64_t seed) {
+  uint64_t x = seed;
+  uint64_t a = splitmix64(&x);
+  uint64_t b = splitmix64(&x);
+
+  // splitmix64 never gives an all zero state
+  r->s[0] = (uint32_t)a;
+  r->s[1] = (uint32_t)(a >> 32);
+  r->s[2] = (uint32_t)b;
+  r->s[3] = (uint32_t)(b >> 32);
+}
+
+uint32_t rngNext(Rng* r) {
+  uint32_t* s = r->s;
+  uint32_t result = rotl(s[1] * 5, 7) * 9;
+  uint32_t t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 11);
+
+  return result;
+}
+
+uint32_t rngBelow(Rng* r, uint32_t n) {
+  // multiply and keep the high word, no division and a negligible bias
+  return (uint32_t)(((uint64_t)rngNext(r) * n) >> 32);
+}
+
+float rngFloat(Rng* r) {
+  // 24 random bits, exactly representable in a float
+  return (rngNext(r) >> 8) * (1.0f / 16777216.0f);
+}
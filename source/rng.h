@@ -0,0 +1,25 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xoshiro128** generator. Each world owns one, so the same seed and the same
+// inputs always give the same game.
+typedef struct {
+    uint32_t s[4];
+} Rng;
+
+
+// Expands the seed with splitmix64, any value is fine including 0
+void seedRng(Rng* r, uint64_t seed);
+
+uint32_t rngNext(Rng* r);
+
+// Uniform in [0, n)
+uint32_t rngBelow(Rng* r, uint32_t n);
+
+// Uniform in [0, 1)
+float rngFloat(Rng* r);
+
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * Simulation thread.
+ * Paces itself on the platform clock: after a frame it sleeps until the
+ * next tick is due. Input arrives through the SPSC ring and leaves as
+ * snapshots, nothing else is shared with the main thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim_thread.h"
+#include "entity.h"
+#include "platform.h"
+#include "profiler.h"
+
+
+void simulateFrame(World* w, InputQueue* input, SnapshotBuffer* snapshots) {
+  // the world applies them at the start of its next tick
+  Command commands[MOVE_PER_CALL];
+  PROFILE_BEGIN(registerInputs);
+  int count = registerInputs(input, commands, MOVE_PER_CALL);
+  PROFILE_END(registerInputs);
+  for (int c = 0; c < count; c++) {
+    queueCommand(w, commands[c]);
+  }
+
+  PROFILE_BEGIN(updateWorldState);
+  updateWorldState(w);
+  PROFILE_END(updateWorldState);
+  publishSnapshot(snapshots, w, w->clock.now);
+}
+
+static void* simThreadMain(void* arg) {
+  SimThread* t = arg;
+  World* w = t->world;
+
+  while (atomic_load_explicit(&t->running, memory_order_acquire)) {
+    uint32_t tick = w->tick;
+    simulateFrame(w, t->input, t->snapshots);
+
+    // nothing was due yet, wait for the rest of the tick
+    if (w->tick == tick) {
+      platformSleep(w->tickDt - w->accumulator);
+    }
+  }
+  return NULL;
+}
+
+bool startSimThread(SimThread* t, World* w, InputQueue* input, SnapshotBuffer* snapshots) {
+  t->world = w;
+  t->input = input;
+  t->snapshots = snapshots;
+  atomic_store(&t->running, true);
+
+  if (pthread_create(&t->thread, NULL, simThreadMain, t) != 0) {
+    printf("Error creating the simulation thread in function startSimThread\n");
+    atomic_store(&t->running, false);
+    return false;
+  }
+  return true;
+}
+
+void stopSimThread(SimThread* t) {
+  atomic_store_explicit(&t->running, false, memory_order_release);
+  pthread_join(t->thread, NULL);
+}
@@ -0,0 +1,34 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "world.h"
+#include "input_queue.h"
+#include "snapshot.h"
+
+// Simulation running on its own thread (SIM_THREAD builds). It owns the
+// World: it drains the input ring, ticks and publishes a snapshot after
+// every tick, render only ever sees the snapshots.
+typedef struct {
+    World* world;
+    InputQueue* input;
+    SnapshotBuffer* snapshots;
+
+    _Atomic bool running;
+    pthread_t thread;
+} SimThread;
+
+
+bool startSimThread(SimThread* t, World* w, InputQueue* input, SnapshotBuffer* snapshots);
+
+// Asks the thread to finish its tick and waits for it
+void stopSimThread(SimThread* t);
+
+// One frame of the simulation: input, ticks, snapshot. The body of the
+// thread, also called from the main loop when there is no thread
+void simulateFrame(World* w, InputQueue* input, SnapshotBuffer* snapshots);
+
+
+#endif
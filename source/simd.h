@@ -0,0 +1,84 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// 4 float lanes over wasm simd128 (emcc -msimd128) or SSE2, just what the
+// kernels of motion.c and narrowphase.c need. Comparisons return lane masks,
+// all bits set or clear. Only include it from .c files.
+
+#if defined(__wasm_simd128__)
+
+#include <wasm_simd128.h>
+
+#define SIMD_LANES 4
+
+typedef v128_t vf;
+typedef v128_t vi;
+
+static inline vf vload(const float* p) { return wasm_v128_load(p); }
+static inline void vstore(float* p, vf v) { wasm_v128_store(p, v); }
+static inline vf vsplat(float f) { return wasm_f32x4_splat(f); }
+static inline vf vadd(vf a, vf b) { return wasm_f32x4_add(a, b); }
+static inline vf vsub(vf a, vf b) { return wasm_f32x4_sub(a, b); }
+static inline vf vmul(vf a, vf b) { return wasm_f32x4_mul(a, b); }
+static inline vf vdiv(vf a, vf b) { return wasm_f32x4_div(a, b); }
+static inline vf vsqrt(vf a) { return wasm_f32x4_sqrt(a); }
+static inline vf vgt(vf a, vf b) { return wasm_f32x4_gt(a, b); }
+static inline vf vlt(vf a, vf b) { return wasm_f32x4_lt(a, b); }
+static inline vf vle(vf a, vf b) { return wasm_f32x4_le(a, b); }
+static inline vf vand(vf a, vf b) { return wasm_v128_and(a, b); }
+static inline vf vor(vf a, vf b) { return wasm_v128_or(a, b); }
+// lanes of mask set take a, the others b
+static inline vf vselect(vf mask, vf a, vf b) { return wasm_v128_bitselect(a, b, mask); }
+
+static inline vi viload(const int* p) { return wasm_v128_load(p); }
+static inline void vistore(int* p, vi v) { wasm_v128_store(p, v); }
+static inline vi visplat(int n) { return wasm_i32x4_splat(n); }
+static inline vi viadd(vi a, vi b) { return wasm_i32x4_add(a, b); }
+static inline vf vieq(vi a, vi b) { return wasm_i32x4_eq(a, b); }
+static inline vi vmaskToInt(vf mask) { return mask; }
+// bit k set when lane k of mask is set
+static inline int vmovemask(vf mask) { return wasm_i32x4_bitmask(mask); }
+
+#elif defined(__SSE2__)
+
+#include <emmintrin.h>
+
+#define SIMD_LANES 4
+
+typedef __m128 vf;
+typedef __m128i vi;
+
+static inline vf vload(const float* p) { return _mm_loadu_ps(p); }
+static inline void vstore(float* p, vf v) { _mm_storeu_ps(p, v); }
+static inline vf vsplat(float f) { return _mm_set1_ps(f); }
+static inline vf vadd(vf a, vf b) { return _mm_add_ps(a, b); }
+static inline vf vsub(vf a, vf b) { return _mm_sub_ps(a, b); }
+static inline vf vmul(vf a, vf b) { return _mm_mul_ps(a, b); }
+static inline vf vdiv(vf a, vf b) { return _mm_div_ps(a, b); }
+static inline vf vsqrt(vf a) { return _mm_sqrt_ps(a); }
+static inline vf vgt(vf a, vf b) { return _mm_cmpgt_ps(a, b); }
+static inline vf vlt(vf a, vf b) { return _mm_cmplt_ps(a, b); }
+static inline vf vle(vf a, vf b) { return _mm_cmple_ps(a, b); }
+static inline vf vand(vf a, vf b) { return _mm_and_ps(a, b); }
+static inline vf vor(vf a, vf b) { return _mm_or_ps(a, b); }
+static inline vf vselect(vf mask, vf a, vf b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline vi viload(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void vistore(int* p, vi v) { _mm_storeu_si128((__m128i*)p, v); }
+static inline vi visplat(int n) { return _mm_set1_epi32(n); }
+static inline vi viadd(vi a, vi b) { return _mm_add_epi32(a, b); }
+static inline vf vieq(vi a, vi b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+static inline vi vmaskToInt(vf mask) { return _mm_castps_si128(mask); }
+static inline int vmovemask(vf mask) { return _mm_movemask_ps(mask); }
+
+#else
+
+// no vector instructions, the kernels only run their scalar path
+#define SIMD_LANES 1
+
+#endif
+
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * World snapshots.
+ * The only state shared between the simulation and render. Slots are
+ * allocated once for the capacity of the world and reused forever.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+
+
+static bool initSnapshot(WorldSnapshot* s, int capacity) {
+  s->count = 0;
+  s->capacity = capacity;
+  s->score = 0;
+  s->lives = 0;
+  s->tick = 0;
+  s->time = 0.0;
+  s->alpha = 1.0f;
+  s->tickDt = 1.0f;
+
+  s->x = malloc(sizeof(float) * capacity);
+  s->y = malloc(sizeof(float) * capacity);
+  s->angle = malloc(sizeof(float) * capacity);
+  s->prevX = malloc(sizeof(float) * capacity);
+  s->prevY = malloc(sizeof(float) * capacity);
+  s->prevAngle = malloc(sizeof(float) * capacity);
+  s->sprite = malloc(sizeof(SpriteId) * capacity);
+
+  return s->x && s->y && s->angle && s->prevX && s->prevY &&
+         s->prevAngle && s->sprite;
+}
+
+static void freeSnapshot(WorldSnapshot* s) {
+  free(s->x);
+  free(s->y);
+  free(s->angle);
+  free(s->prevX);
+  free(s->prevY);
+  free(s->prevAngle);
+  free(s->sprite);
+  s->count = 0;
+  s->capacity = 0;
+}
+
+bool initSnapshotBuffer(SnapshotBuffer* b, int capacity) {
+  // slots after a failed one are freed too, they must hold NULLs
+  memset(b->slots, 0, sizeof(b->slots));
+  for (int i = 0; i < 3; i++) {
+    if (!initSnapshot(&b->slots[i], capacity)) {
+      printf("ERROR: Out of memory when creating the world snapshots\n");
+      freeSnapshotBuffer(b);
+      return false;
+    }
+  }
+
+  b->back = 0;
+  atomic_store(&b->middle, 1);
+  b->front = 2;
+  return true;
+}
+
+void freeSnapshotBuffer(SnapshotBuffer* b) {
+  for (int i = 0; i < 3; i++) {
+    freeSnapshot(&b->slots[i]);
+  }
+}
+
+void publishSnapshot(SnapshotBuffer* b, const World* w, double now) {
+  const EntityStore* e = &w->entities;
+  WorldSnapshot* s = &b->slots[b->back];
+
+  int count = e->count < s->capacity ? e->count : s->capacity;
+  size_t bytes = sizeof(float) * count;
+
+  memcpy(s->x, e->x, bytes);
+  memcpy(s->y, e->y, bytes);
+  memcpy(s->angle, e->angle, bytes);
+  memcpy(s->prevX, e->prevX, bytes);
+  memcpy(s->prevY, e->prevY, bytes);
+  memcpy(s->prevAngle, e->prevAngle, bytes);
+  memcpy(s->sprite, e->sprite, sizeof(SpriteId) * count);
+  s->count = count;
+
+  int player = storeIndex(e, w->player);
+  s->score = w->score;
+  s->lives = player >= 0 ? e->lives[player] : 0;
+  s->tick = w->tick;
+  s->time = now;
+  s->alpha = w->alpha;
+  s->tickDt = w->tickDt;
+
+  // release: the copy above is visible to whoever picks this slot up
+  int old = atomic_exchange_explicit(&b->middle, b->back | SNAPSHOT_FRESH,
+                                     memory_order_acq_rel);
+  b->back = old & ~SNAPSHOT_FRESH;
+}
+
+const WorldSnapshot* latestSnapshot(SnapshotBuffer* b) {
+  if (atomic_load_explicit(&b->middle, memory_order_relaxed) & SNAPSHOT_FRESH) {
+    int old = atomic_exchange_explicit(&b->middle, b->front, memory_order_acq_rel);
+    b->front = old & ~SNAPSHOT_FRESH;
+  }
+  return &b->slots[b->front];
+}
+
+float snapshotAlpha(const WorldSnapshot* s, double now) {
+  // time since the snapshot was taken moves render further towards the tick
+  float alpha = s->alpha + (float)((now - s->time) / s->tickDt);
+  if (alpha < 0.0f) alpha = 0.0f;
+  if (alpha > 1.0f) alpha = 1.0f;
+  return alpha;
+}
@@ -0,0 +1,60 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "atlas.h"
+#include "world.h"
+
+// What render needs from one tick of the world, copied out of the store so
+// the simulation can go on while it is drawn
+typedef struct {
+    int count;
+    int capacity;
+
+    float* x;
+    float* y;
+    float* angle;
+    float* prevX;
+    float* prevY;
+    float* prevAngle;
+    SpriteId* sprite;
+
+    int score;
+    int lives;              // of the player, 0 if there is none
+    uint32_t tick;
+
+    double time;            // platformNow when it was taken
+    float alpha;            // world alpha at that time
+    float tickDt;
+} WorldSnapshot;
+
+// Set in SnapshotBuffer.middle when it holds a snapshot render has not seen
+#define SNAPSHOT_FRESH 4
+
+// Triple buffer: the simulation fills back, then swaps it with middle.
+// render swaps front with middle when middle is fresh. Neither side waits
+// and render always reads a complete snapshot.
+typedef struct {
+    WorldSnapshot slots[3];
+    _Atomic int middle;     // slot index | SNAPSHOT_FRESH
+    int back;               // owned by the simulation
+    int front;              // owned by render
+} SnapshotBuffer;
+
+
+bool initSnapshotBuffer(SnapshotBuffer* b, int capacity);
+void freeSnapshotBuffer(SnapshotBuffer* b);
+
+// Simulation side: copies the world into the back slot and publishes it
+void publishSnapshot(SnapshotBuffer* b, const World* w, double now);
+
+// Render side: newest published snapshot, the previous one if nothing new
+const WorldSnapshot* latestSnapshot(SnapshotBuffer* b);
+
+// How far between the last two ticks to draw at time now, in [0, 1]
+float snapshotAlpha(const WorldSnapshot* s, double now);
+
+
+#endif
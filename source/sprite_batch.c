@@ -0,0 +1,90 @@
+/**
+ * Sprite batcher.
+ * Every sprite is an instance of the same unit quad, textured from the atlas.
+ * The instances of a whole frame, built by the render list, are uploaded in
+ * one buffer and drawn with a single instanced call and a single texture bind.
+ * The instance attributes are recorded in the VAO of the quad at init, a
+ * flush only uploads and draws, the state cache drops the binds that are
+ * already current.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <GLES3/gl3.h>
+
+#include "sprite_batch.h"
+#include "graphics.h"
+#include "texture.h"
+#include "mesh.h"
+#include "gl_state.h"
+
+static GLuint instance_vbo;
+
+static TextureId atlas;
+static SpriteBatchStats stats;
+
+
+void initSpriteBatch(void) {
+  glGenBuffers(1, &instance_vbo);
+
+  // the instance layout goes into the VAO of the quad, next to its vertices.
+  // Orphaning the buffer on upload keeps its name, so the pointers stay valid
+  const Mesh* quad = getMesh(MESH_QUAD);
+  bindVertexArrayCached(quad->vao);
+  bindBufferCached(GL_ARRAY_BUFFER, instance_vbo);
+
+  const GLsizei stride = INSTANCE_FLOATS * sizeof(GLfloat);
+  glVertexAttribPointer(translation_location, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+  glVertexAttribPointer(angle_location, 1, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(GLfloat)));
+  glVertexAttribPointer(scale_location, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(GLfloat)));
+  glVertexAttribPointer(uvRect_location, 4, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(GLfloat)));
+
+  glEnableVertexAttribArray(translation_location);
+  glEnableVertexAttribArray(angle_location);
+  glEnableVertexAttribArray(scale_location);
+  glEnableVertexAttribArray(uvRect_location);
+
+  // instance attributes advance once per drawn quad, not per vertex
+  glVertexAttribDivisor(translation_location, 1);
+  glVertexAttribDivisor(angle_location, 1);
+  glVertexAttribDivisor(scale_location, 1);
+  glVertexAttribDivisor(uvRect_location, 1);
+
+  bindVertexArrayCached(0);
+
+  atlas = acquireTexture(TEXTURE_ATLAS);
+}
+
+void flushSpriteBatch(const RenderList* list) {
+  int instanceCount = list->count;
+  stats.sprites = instanceCount;
+  stats.drawCalls = 0;
+
+  if (instanceCount == 0) {
+    return;
+  }
+
+  // 1) Upload all instances at once, orphaning last frame's storage
+  const Mesh* quad = getMesh(MESH_QUAD);
+  bindVertexArrayCached(quad->vao);
+  bindBufferCached(GL_ARRAY_BUFFER, instance_vbo);
+  glBufferData(GL_ARRAY_BUFFER,
+               sizeof(GLfloat) * INSTANCE_FLOATS * instanceCount,
+               list->data,
+               GL_STREAM_DRAW);
+  countGlCall();
+
+  // 2) One texture, one draw
+  activeTextureCached(GL_TEXTURE0);
+  bindTextureCached(textureHandle(atlas));
+  uniform1iCached(texture_location, 0);
+
+  glDrawElementsInstanced(GL_TRIANGLES, quad->numIndices, GL_UNSIGNED_SHORT, 0, instanceCount);
+  countGlCall();
+  stats.drawCalls++;
+}
+
+SpriteBatchStats spriteBatchStats(void) {
+  return stats;
+}
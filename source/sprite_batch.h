@@ -0,0 +1,24 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <GLES3/gl3.h>
+#include "render_list.h"
+
+// What the last flush cost. Texture binds are counted by bindTextureCached,
+// see glCallStats: the cache filters the atlas bind after the first frame
+typedef struct {
+    int sprites;
+    int drawCalls;
+} SpriteBatchStats;
+
+
+// Needs the attribute locations of the program, called from initGraphics
+void initSpriteBatch(void);
+
+// Uploads every sprite of the list and draws them in one call
+void flushSpriteBatch(const RenderList* list);
+
+SpriteBatchStats spriteBatchStats(void);
+
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * Startup timeline.
+ * Stages overlap (the bundle is read while the world is set up) so each is
+ * reported with its own duration, the first frame as the time since start.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "startup.h"
+#include "platform.h"
+
+
+typedef struct {
+    double begin;
+    double end;
+    bool recorded;
+} StageTime;
+
+static StageTime stages[STARTUP_STAGE_COUNT];
+static const char* stageNames[STARTUP_STAGE_COUNT] = {
+    [STARTUP_INSTANTIATE] = "instantiate",
+    [STARTUP_ASSETS] = "assets",
+    [STARTUP_UPLOAD] = "upload",
+};
+
+static bool firstFrameDrawn = false;
+
+
+void startupStage(StartupStage stage, double begin, double end) {
+  stages[stage].begin = begin;
+  stages[stage].end = end;
+  stages[stage].recorded = true;
+}
+
+void startupFrameDrawn(void) {
+  if (firstFrameDrawn) {
+    return;
+  }
+  firstFrameDrawn = true;
+  double now = platformWallNow();
+
+  printf("startup   ");
+  for (int i = 0; i < STARTUP_STAGE_COUNT; i++) {
+    if (stages[i].recorded) {
+      printf(" %s %.2f ms  ", stageNames[i], (stages[i].end - stages[i].begin) * 1000.0);
+    }
+  }
+  printf(" first frame at %.2f ms\n", (now - platformStartTime()) * 1000.0);
+}
@@ -0,0 +1,24 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+// Time to first frame, split in the stages startup goes through. Each
+// stage is recorded once with its begin and end on platformWallNow, the
+// timeline is printed when the first frame with every asset is drawn.
+
+typedef enum {
+    STARTUP_INSTANTIATE,    // page or process start to main: download,
+                            // wasm compile and instantiate, preload
+    STARTUP_ASSETS,         // mapping and checking the asset bundle
+    STARTUP_UPLOAD,         // texture uploads, spread over frames
+    STARTUP_STAGE_COUNT
+} StartupStage;
+
+
+void startupStage(StartupStage stage, double begin, double end);
+
+// Called after every frame that drew the game. The first call records the
+// first frame and prints the timeline, the next ones do nothing
+void startupFrameDrawn(void);
+
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * Texture registry.
+ * Each image is uploaded exactly once during the loading phase, straight
+ * from the asset bundle where it is already premultiplied RGBA, a band of
+ * rows per frame. Users only take a reference on the shared GL texture.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GLES2/gl2.h>
+
+#include "texture.h"
+#include "atlas.h"
+#include "asset_bundle.h"
+#include "gl_state.h"
+
+
+typedef struct {
+    const char* name;       // in the asset bundle
+    GLuint handle;
+    int refCount;
+    int uploadedRows;       // of its bundle image so far
+} TextureEntry;
+
+static TextureEntry textures[TEXTURE_COUNT] = {
+    [TEXTURE_ATLAS] = {ATLAS_ASSET, 0, 0, 0},
+};
+
+// textures before this one are fully uploaded
+static int uploading = 0;
+
+static int liveTextures = 0;
+
+
+GLuint uploadTexture(int width, int height, const void* pixels) {
+  GLuint imageId;
+  glGenTextures(1, &imageId);
+  bindTextureCached(imageId);
+
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+               width, height, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  return imageId;
+}
+
+bool uploadTextures(const AssetBundle* bundle, size_t budget) {
+  bool uploaded = false;
+  while (uploading < TEXTURE_COUNT) {
+    TextureEntry* t = &textures[uploading];
+    const BundleEntry* e = findAsset(bundle, t->name);
+    if (!e) {
+      printf("Failed to find texture %s in %s\n", t->name, ASSET_BUNDLE_PATH);
+      t->refCount = 1;
+      uploading++;
+      continue;
+    }
+
+    // storage first, the rows follow in bands of at most budget bytes
+    if (t->handle == 0) {
+      t->handle = uploadTexture((int)e->width, (int)e->height, NULL);
+      t->refCount = 1;
+      liveTextures++;
+    }
+
+    size_t rowSize = (size_t)e->width * 4;
+    int left = (int)e->height - t->uploadedRows;
+    int rows = (int)(budget / rowSize);
+    if (rows > left) rows = left;
+    if (rows < 1) {
+      // a row wider than the budget still goes, alone in its frame
+      if (uploaded) break;
+      rows = 1;
+    }
+
+    bindTextureCached(t->handle);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, t->uploadedRows, (int)e->width, rows,
+                    GL_RGBA, GL_UNSIGNED_BYTE,
+                    assetPixels(bundle, e) + (size_t)t->uploadedRows * rowSize);
+    t->uploadedRows += rows;
+    uploaded = true;
+    if (t->uploadedRows == (int)e->height) {
+      uploading++;
+    }
+
+    size_t spent = (size_t)rows * rowSize;
+    if (spent >= budget) {
+      break;
+    }
+    budget -= spent;
+  }
+  return uploading == TEXTURE_COUNT;
+}
+
+void freeTextures(void) {
+  for (int i = 0; i < TEXTURE_COUNT; i++) {
+    if (textures[i].refCount > 0) {
+      releaseTexture(i);
+    }
+  }
+}
+
+TextureId acquireTexture(TextureId id) {
+  textures[id].refCount++;
+  return id;
+}
+
+void releaseTexture(TextureId id) {
+  TextureEntry* t = &textures[id];
+  if (t->refCount <= 0) {
+    printf("ERROR: releasing texture %s more times than it was acquired\n", t->name);
+    return;
+  }
+
+  t->refCount--;
+  if (t->refCount == 0 && t->handle != 0) {
+    deleteTextureCached(t->handle);
+    t->handle = 0;
+    liveTextures--;
+  }
+}
+
+GLuint textureHandle(TextureId id) {
+  return textures[id].handle;
+}
+
+int textureRefCount(TextureId id) {
+  return textures[id].refCount;
+}
+
+int liveTextureCount(void) {
+  return liveTextures;
+}
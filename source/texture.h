@@ -0,0 +1,44 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <GLES2/gl2.h>
+#include "asset_bundle.h"
+
+// Every texture the game uses, uploaded once by uploadTextures from the
+// asset bundle.
+// The sprites are all packed in the atlas, see atlas.h
+typedef enum {
+    TEXTURE_ATLAS,
+    TEXTURE_COUNT
+} TextureId;
+
+
+// RGBA8 texture with premultiplied alpha, uploaded as is
+GLuint uploadTexture(int width, int height, const void* pixels);
+
+// Bytes of pixels handed to GL per frame of the loading phase
+#define UPLOAD_BUDGET (512 * 1024)
+
+// Uploads the next budget bytes of the textures, true once all of them are
+// in GL. The registry keeps one reference on each of them
+bool uploadTextures(const AssetBundle* bundle, size_t budget);
+
+// Drops the registry references, textures still in use stay alive
+void freeTextures(void);
+
+// Shared id, must be given back with releaseTexture
+TextureId acquireTexture(TextureId id);
+void releaseTexture(TextureId id);
+
+// GL name to bind, 0 if the asset failed to load
+GLuint textureHandle(TextureId id);
+
+int textureRefCount(TextureId id);
+
+// Number of GL textures currently allocated
+int liveTextureCount(void);
+
+
+#endif
@@ -1,275 +1,462 @@
+
 #include <stdio.h>
 #include <stdlib.h>
-#include <emscripten.h>
-#include <emscripten/html5.h>
-#include <sys/time.h>
-#include <unistd.h>
+#include <math.h>
 
 #include "world.h"
 #include "entity.h"
+#include "motion.h"
+#include "narrowphase.h"
+#include "profiler.h"
+
+void initWorld(World* w, uint64_t seed) {
+  initWorldSized(w, seed, MAX_BULLET, ASTEROID_CAP);
+}
+
+void initWorldSized(World* w, uint64_t seed, int maxBullets, int maxAsteroids) {
+  // every random draw of the game comes from here
+  w->seed = seed;
+  seedRng(&w->rng, seed);
 
-void initWorld(World* w) {
-  srand(time(NULL));
   w->max_x = 1.0f;
   w->max_y = 1.0f;
   w->min_x = -1.0f;
   w->min_y = -1.0f;
 
-  w->head = NULL;
-  w->tail = NULL;
-
-  w->timeLastSpawn = timeInMilliseconds();
-  w->timeSpawn = 5000;
+  initFrameClock(&w->clock);
+  setTickRate(w, SIM_TICK_RATE);
+  w->accumulator = 0.0;
+  w->alpha = 1.0f;
+  w->simTime = 0.0;
+  w->tick = 0;
+  w->pendingCount = 0;
+  w->recorder = NULL;
+  w->timeLastSpawn = w->simTime;
+  w->timeSpawn = 5.0f;
   w->entityCount = 0;
   w->score = 0;
 
-  // Create the player on the heap
-  Entity* player = malloc(sizeof(Entity));
-  initPlayer(player);    
-  addEntity(w, player);
+  // Every entity lives in the store, nothing is malloc'd while playing
+  int capacity = 1 + maxBullets + maxAsteroids;
+  if (!initEntityStore(&w->entities, capacity)) {
+    printf("Error creating the entity store in function initWorld\n");
+    exit(1);
+  }
+
+  // a cell must hold the largest asteroid plus the largest thing hitting it
+  float cellSize = radiusOf(ASTEROID, 3) + fmaxf(radiusOf(SHIP, 0), radiusOf(BULLET, 0));
+  if (!initGrid(&w->grid, cellSize, capacity)) {
+    printf("Error creating the collision grid in function initWorld\n");
+    exit(1);
+  }
+
+  w->killList = malloc(sizeof(int) * capacity);
+  if (!w->killList) {
+    printf("Error creating the kill list in function initWorld\n");
+    exit(1);
+  }
+  w->collisionPairs = 0;
+
+  int caps[3] = {1, maxBullets, maxAsteroids};
+  for (int k = 0; k < 3; k++) {
+    w->budget[k].count = 0;
+    w->budget[k].capacity = caps[k];
+    w->budget[k].highWater = 0;
+    w->budget[k].refused = 0;
+  }
+
+  Entity player;
+  initPlayer(&player);
+  w->player = addEntity(w, &player);
 }
 
-EM_JS(void, showHud, (int score, int lives), {
-  document.getElementById('hud').textContent =
-    'Score: ' + score + '\n   Lives: ' + lives;
-});
+void freeWorld(World* w) {
+  freeEntityStore(&w->entities);
+  freeGrid(&w->grid);
+  free(w->killList);
+  w->killList = NULL;
+}
 
-void displayGameState(World* w) {
-  EntityNode* playerNode = w->head;
-  if (!playerNode) return;
+bool hasRoom(World* w, int type, int n) {
+  KindBudget* b = &w->budget[type];
+  if (b->count + n > b->capacity) {
+    b->refused += n;
+    return false;
+  }
+  return true;
+}
 
-  int score = w->score;
-  int lives = playerNode->e->lives;
-  showHud(score, lives);
+void printWorldStats(World* w) {
+  const char* names[3] = {"ship", "bullet", "asteroid"};
+  for (int k = 0; k < 3; k++) {
+    printf("%-10s used %3d / %3d   high water %3d   refused %d\n",
+           names[k], w->budget[k].count, w->budget[k].capacity,
+           w->budget[k].highWater, w->budget[k].refused);
+  }
+  printPoolStats("slots", &w->entities.slots);
+  printf("collision  %d candidate pairs in a %dx%d grid\n",
+         w->collisionPairs, w->grid.cellsPerSide, w->grid.cellsPerSide);
 }
 
 void restartWorld(World* w) {
-  // we'll repeatedly remove w->head until it's empty.
-  while (w->head) {
-    removeEntity(w, w->head);
+  // one file per game over, holding the whole session so far
+  if (w->recorder) {
+    saveRecording(w->recorder, w->tick);
+  }
+
+  // removing from the end never moves anything
+  while (w->entities.count > 0) {
+    removeEntity(w, w->entities.count - 1);
   }
 
   // Reset world variables
   w->score = 0;
-  w->timeLastSpawn = timeInMilliseconds();  
+  w->timeLastSpawn = w->simTime;
   w->entityCount = 0;
 
-  Entity* player = malloc(sizeof(Entity));
-  initPlayer(player);    
-  addEntity(w, player);
+  Entity player;
+  initPlayer(&player);
+  w->player = addEntity(w, &player);
 
   printf("The world has been restarted.\n");
+  printWorldStats(w);
 }
 
 
-void updateWorldState(World* w) {
-
-  if(w->head->e->lives == 0){
-    restartWorld(w);
+void setTickRate(World* w, float ticksPerSecond) {
+  if (ticksPerSecond <= 0.0f) {
+    printf("ERROR: invalid tick rate %f\n", ticksPerSecond);
+    return;
   }
+  w->tickRate = ticksPerSecond;
+  w->tickDt = 1.0f / ticksPerSecond;
+}
 
-  displayGameState(w);
+bool queueCommand(World* w, Command command) {
+  if (w->pendingCount >= MAX_TICK_COMMANDS) {
+    return false;
+  }
+  w->pending[w->pendingCount++] = command;
+  return true;
+}
 
-  EntityNode* playerNode = w->head;
-  if (!playerNode) {
-    printf("No entities in the world!\n");
-    return;
+// FNV-1a step over the 4 bytes of an int or a float
+static uint32_t mixWord(uint32_t h, const void* word) {
+  const unsigned char* bytes = word;
+  for (int b = 0; b < 4; b++) {
+    h ^= bytes[b];
+    h *= 16777619u;
   }
+  return h;
+}
 
+uint32_t worldChecksum(const World* w) {
+  const EntityStore* s = &w->entities;
+  uint32_t h = 2166136261u;
+
+  h = mixWord(h, &w->tick);
+  h = mixWord(h, &w->score);
+  h = mixWord(h, &s->count);
+  for (int i = 0; i < s->count; i++) {
+    h = mixWord(h, &s->type[i]);
+    h = mixWord(h, &s->lives[i]);
+    h = mixWord(h, &s->x[i]);
+    h = mixWord(h, &s->y[i]);
+    h = mixWord(h, &s->vx[i]);
+    h = mixWord(h, &s->vy[i]);
+    h = mixWord(h, &s->angle[i]);
+  }
+  return h;
+}
 
+void updateWorldState(World* w) {
+  // one clock sample for the whole frame
+  tickFrameClock(&w->clock);
+  w->accumulator += w->clock.dt;
+
+  int steps = 0;
+  while (w->accumulator >= w->tickDt && steps < MAX_CATCH_UP_STEPS) {
+    stepWorld(w, w->tickDt);
+    w->accumulator -= w->tickDt;
+    steps++;
+  }
 
-  if (playerNode->e->shoot) {
-    // Allocate bullet
-    Entity* bullet = malloc(sizeof(Entity));
-    initBullet(playerNode->e, bullet);
-    addEntity(w, bullet);
-    playerNode->e->shoot = false;
+  // too far behind, drop the backlog rather than spiral
+  if (steps == MAX_CATCH_UP_STEPS && w->accumulator >= w->tickDt) {
+    w->accumulator = 0.0;
   }
 
-  // Update each entity
-  EntityNode* curr = w->head;
-  while (curr) {
-    EntityNode* next = curr->next;
+  w->alpha = (float)(w->accumulator / w->tickDt);
+}
 
-    if (curr->e->lives <= 0) {
-      removeEntity(w, curr);
-      curr = next;
+void stepWorld(World* w, float dt) {
+  EntityStore* s = &w->entities;
 
-      continue;
-    }
+  w->simTime += dt;
 
-    if (curr == playerNode) {
-      updatePosition(curr->e, 0.005f);
-    } else {
-      updatePosition(curr->e, 0.0f);
-    }
-    curr = next;
+  int player = storeIndex(s, w->player);
+  if (player < 0) {
+    printf("No player in the world!\n");
+    return;
   }
 
-  // Spawn after a certain moment
-  if ((timeInMilliseconds() - w->timeLastSpawn) > w->timeSpawn) {
-    Entity* asteroid = malloc(sizeof(Entity));
-    initAsteroid0(asteroid);
-    addEntity(w, asteroid);
-    w->timeLastSpawn = timeInMilliseconds();
+  if(s->lives[player] == 0){
+    restartWorld(w);
+    player = storeIndex(s, w->player);
+  }
+
+  // the commands of the tick, in the order they were typed
+  for (int c = 0; c < w->pendingCount; c++) {
+    applyCommand(s, player, w->pending[c]);
+    if (w->recorder) {
+      recordCommand(w->recorder, w->tick, w->pending[c]);
+    }
+  }
+  w->pendingCount = 0;
+
+  if (s->shoot[player]) {
+    // the shot is lost if every bullet is already flying
+    if (hasRoom(w, BULLET, 1)) {
+      Entity bullet;
+      initBullet(s, player, &bullet);
+      addEntity(w, &bullet);
+    }
+    s->shoot[player] = false;
   }
 
+  PROFILE_BEGIN(updateEntities);
+  updateEntities(w, dt);
+  PROFILE_END(updateEntities);
+
+  PROFILE_BEGIN(spawnAsteroids);
+  spawnAsteroids(w);
+  PROFILE_END(spawnAsteroids);
+
+  PROFILE_BEGIN(collisionDetection);
   collisionDetection(w);
+  PROFILE_END(collisionDetection);
+
+  PROFILE_BEGIN(reclaimDeadEntities);
+  reclaimDeadEntities(w);
+  PROFILE_END(reclaimDeadEntities);
+
+  w->tick++;
+}
+
+void updateEntities(World* w, float dt) {
+  EntityStore* s = &w->entities;
+
+  // render interpolates from this state
+  storeSavePrevious(s);
+
+  // the dead were reclaimed at the end of the last tick
+  integrateMotion(s, dt);
+}
+
+void spawnAsteroids(World* w) {
+  // Spawn after a certain moment
+  if ((w->simTime - w->timeLastSpawn) > w->timeSpawn) {
+    if (hasRoom(w, ASTEROID, 1)) {
+      Entity asteroid;
+      initAsteroid0(&w->rng, &asteroid);
+      addEntity(w, &asteroid);
+    }
+    w->timeLastSpawn = w->simTime;
+  }
 }
 
 
 
 
 void collisionDetection(World* w) {
-  EntityNode* nodeA = w->head;
-  while (nodeA) {
-    EntityNode* nextA = nodeA->next;
-
-    EntityNode* nodeB = nodeA->next;
-    while (nodeB) {
-      EntityNode* nextB = nodeB->next;
-
-      // Bullet vs. Asteroid
-      if ((nodeA->e->type == BULLET && nodeB->e->type == ASTEROID) ||
-        (nodeA->e->type == ASTEROID && nodeB->e->type == BULLET))
-      {
-        if (checkCollision(nodeA->e, nodeB->e)) {
-          if (nodeA->e->type == BULLET) {
-            bulletAsteroidCollision(w, nodeA, nodeB);
-          } else {
-            bulletAsteroidCollision(w, nodeB, nodeA);
+  EntityStore* s = &w->entities;
+  Grid* g = &w->grid;
+
+  // Only bullets and the ship can hit an asteroid, so only asteroids go in
+  // the grid and asteroid/asteroid or bullet/bullet pairs are never tested
+  buildGrid(g, s, ASTEROID);
+  w->collisionPairs = 0;
+
+  for (int a = 0; a < s->count; a++) {
+    int typeA = s->type[a];
+    if ((typeA != BULLET && typeA != SHIP) || s->lives[a] <= 0) {
+      continue;
+    }
+
+    int cells[9];
+    int cellCount = gridNeighbours(g, s->x[a], s->y[a], cells);
+    bool hit = false;
+
+    for (int c = 0; c < cellCount && !hit; c++) {
+      int k = g->cellStart[cells[c]];
+      int end = g->cellStart[cells[c] + 1];
+
+      // the cell in batches, hits are handled in cell order
+      while (k < end && !hit) {
+        int n = end - k < NARROWPHASE_BATCH ? end - k : NARROWPHASE_BATCH;
+        uint32_t mask = collideCircles(s->x[a], s->y[a], s->radius[a],
+                                       &g->itemX[k], &g->itemY[k], &g->itemRadius[k], n);
+        w->collisionPairs += n;
+        int next = k + n;
+
+        while (mask != 0) {
+          int bit = __builtin_ctz(mask);
+          mask &= mask - 1;
+
+          // killed earlier in this tick
+          int b = g->items[k + bit];
+          if (s->lives[b] <= 0) {
+            continue;
           }
-          break; // exit the inner loop for nodeA
-        }
-      }
-      // Ship vs Asteroid
-      if ((nodeA->e->type == SHIP && nodeB->e->type == ASTEROID) ||
-        (nodeA->e->type == ASTEROID && nodeB->e->type == SHIP))
-      {
-        if (checkCollision(nodeA->e, nodeB->e)) {
-          if (nodeA->e->type == SHIP) {
-            shipAsteroidCollision(nodeA, nodeB);
-          } else {
-            shipAsteroidCollision(nodeB, nodeA);
+
+          if (typeA == BULLET) {
+            // Bullet vs. Asteroid, a bullet only destroys one asteroid
+            bulletAsteroidCollision(w, a, b);
+            hit = true;
+            break;
           }
+          // Ship vs Asteroid, the ship respawns at the centre so the rest
+          // of the batch is tested again from there
+          shipAsteroidCollision(s, a, b);
+          next = k + bit + 1;
+          break;
         }
+        k = next;
       }
-
-      nodeB = nextB;
     }
-
-    nodeA = nextA;
   }
 }
 
 
 
-void bulletAsteroidCollision(World* w, EntityNode* bulletNode, EntityNode* asteroidNode) {
+void bulletAsteroidCollision(World* w, int bullet, int asteroid) {
+  EntityStore* s = &w->entities;
+
   // Increase score
   w->score += 10;
 
-  if(asteroidNode->e->lives == 3){
+  if(s->lives[asteroid] == 3){
     w->entityCount += 2 * VAL_ASTEROID2;
-  }else if(asteroidNode->e->lives == 2){
+  }else if(s->lives[asteroid] == 2){
     w->entityCount += 2 * VAL_ASTEROID1;
   }
 
   // If the bullet is still alive
-  if (bulletNode->e->lives > 0 && bulletNode->e->type == BULLET) {
-    // Optionally split the asteroid
-    Entity* a = malloc(sizeof(Entity));
-    Entity* b = malloc(sizeof(Entity));
-    splitAsteroid(asteroidNode->e, a, b);
+  if (s->lives[bullet] > 0 && s->type[bullet] == BULLET) {
+    // Split the asteroid unless it is already the smallest one,
+    // new entities are appended so bullet and asteroid keep their index
+    if (s->lives[asteroid] > 1 && hasRoom(w, ASTEROID, 2)) {
+      Entity a;
+      Entity b;
+      splitAsteroid(&w->rng, s, asteroid, &a, &b);
+      addEntity(w, &a);
+      addEntity(w, &b);
+    }
 
     // Mark both bullet & asteroid for removal
-    bulletNode->e->lives = 0;
-    asteroidNode->e->lives = 0;
-
-    // Add child asteroids if created
-    if (a) addEntity(w, a);
-    if (b) addEntity(w, b);
+    s->lives[bullet] = 0;
+    s->lives[asteroid] = 0;
   }
 }
 
 
 
-void shipAsteroidCollision(EntityNode* shipNode, EntityNode* asteroidNode) {
-  if (shipNode->e->type == SHIP) {
-    shipNode->e->lives--;
-    shipNode->e->x = 0;
-    shipNode->e->y = 0;
-    shipNode->e->vx = 0;
-    shipNode->e->vy = 0;
-    shipNode->e->angle = 0;
+void shipAsteroidCollision(EntityStore* s, int ship, int asteroid) {
+  if (s->type[ship] == SHIP) {
+    s->lives[ship]--;
+    s->x[ship] = 0;
+    s->y[ship] = 0;
+    s->vx[ship] = 0;
+    s->vy[ship] = 0;
+    s->angle[ship] = 0;
+    // respawn in place, nothing to interpolate from
+    s->prevX[ship] = 0;
+    s->prevY[ship] = 0;
+    s->prevAngle[ship] = 0;
   } else {
-    asteroidNode->e->lives--;
-    asteroidNode->e->x = 0;
-    asteroidNode->e->y = 0;
-    asteroidNode->e->vx = 0;
-    asteroidNode->e->vy = 0;
-    asteroidNode->e->angle = 0;
+    s->lives[asteroid]--;
+    s->radius[asteroid] = radiusOf(ASTEROID, s->lives[asteroid]);
+    s->x[asteroid] = 0;
+    s->y[asteroid] = 0;
+    s->vx[asteroid] = 0;
+    s->vy[asteroid] = 0;
+    s->angle[asteroid] = 0;
   }
 }
 
 
 
-EntityNode* addEntity(World* w, Entity* src) {
-  EntityNode* newNode = malloc(sizeof(EntityNode));
-  if (!newNode) {
-    printf("ERROR: Out of memory when adding an entity\n");
-    return NULL;
-  }
+EntityHandle addEntity(World* w, const Entity* src) {
+  EntityStore* s = &w->entities;
+  EntityHandle h;
 
-  // Store pointer
-  newNode->e = src;
-  newNode->prev = NULL;
-  newNode->next = NULL;
+  int i = storeCreate(s, &h);
+  if (i < 0) {
+    printf("ERROR: Entity store is full when adding an entity\n");
+    return h;
+  }
 
-  if (!w->head) {
-    w->head = newNode;
-    w->tail = newNode;
-  } else {
-    w->tail->next = newNode;
-    newNode->prev = w->tail;
-    w->tail = newNode;
+  s->type[i] = src->type;
+  s->x[i] = src->x;
+  s->y[i] = src->y;
+  s->vx[i] = src->vx;
+  s->vy[i] = src->vy;
+  s->angle[i] = src->angle;
+  s->prevX[i] = src->x;
+  s->prevY[i] = src->y;
+  s->prevAngle[i] = src->angle;
+  s->lives[i] = src->lives;
+  s->sprite[i] = src->sprite;
+  // computed once here rather than for every tested pair
+  s->radius[i] = radiusOf(src->type, src->lives);
+
+  KindBudget* b = &w->budget[src->type];
+  b->count++;
+  if (b->count > b->highWater) {
+    b->highWater = b->count;
   }
 
-  return newNode;
+  return h;
 }
 
-void removeEntity(World* w, EntityNode* node) {
+// Budget and asteroid count bookkeeping of a removal
+static void forgetEntity(World* w, int i) {
+  EntityStore* s = &w->entities;
 
-  if (!node) return;
-
-  if(node->e->type == ASTEROID){
-    if(node->e->lives == 3){
+  if(s->type[i] == ASTEROID){
+    if(s->lives[i] == 3){
       w->entityCount -= VAL_ASTEROID1;
-    }else if (node->e->lives == 2){
+    }else if (s->lives[i] == 2){
       w->entityCount -= VAL_ASTEROID2;
-    }else if (node->e->lives == 1){
+    }else if (s->lives[i] == 1){
       w->entityCount -= VAL_ASTEROID3;
     }
   }
 
-  // Unlink
-  if (node == w->head) {
-    w->head = node->next;
-    if (w->head) {
-      w->head->prev = NULL;
-    } else {
-      w->tail = NULL;
-    }
-  } else {
-    node->prev->next = node->next;
-    if (node->next) {
-      node->next->prev = node->prev;
-    } else {
-      w->tail = node->prev;
+  w->budget[s->type[i]].count--;
+}
+
+void removeEntity(World* w, int i) {
+  EntityStore* s = &w->entities;
+
+  if (i < 0 || i >= s->count) return;
+
+  forgetEntity(w, i);
+  storeRemove(s, i);
+}
+
+void reclaimDeadEntities(World* w) {
+  EntityStore* s = &w->entities;
+
+  // one scan, so the kill list comes out sorted
+  int n = 0;
+  for (int i = 0; i < s->count; i++) {
+    if (s->lives[i] > 0 || s->type[i] == SHIP) {
+      continue;
     }
+    forgetEntity(w, i);
+    w->killList[n++] = i;
   }
 
-  removeEntityGraphics(node->e);
-  free(node->e);
-  free(node);
+  storeRemoveSorted(s, w->killList, n);
 }
-
@@ -2,20 +2,42 @@
 #define WORLD_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "entity.h"
+#include "broadphase.h"
+#include "frame_clock.h"
+#include "rng.h"
+#include "replay.h"
 
 
+// Simulation ticks per second, can also be changed with setTickRate
+#ifndef SIM_TICK_RATE
+#define SIM_TICK_RATE 60
+#endif
+
+// Ticks run in one frame at most before the simulation gives up catching up
+#define MAX_CATCH_UP_STEPS 5
+
+// Commands applied on one tick at most, the rest waits for the next one
+#define MAX_TICK_COMMANDS 32
+
 #define MAX_ASTEROID 20
 #define VAL_ASTEROID1 4
 #define VAL_ASTEROID2 2 
 #define VAL_ASTEROID3 1
 
-// Doubly linked list node
-typedef struct EntityNode {
-    struct EntityNode* prev;
-    struct EntityNode* next;
-    Entity* e;    // Store the Entity by value, or store `Entity* e;` if you prefer
-} EntityNode;
+// Entity budgets, a big asteroid ends up as four small ones
+#define MAX_BULLET 64
+#define ASTEROID_CAP (MAX_ASTEROID * VAL_ASTEROID1)
+#define ENTITY_CAP (1 + MAX_BULLET + ASTEROID_CAP)
+
+// Occupancy of one entity kind in the store
+typedef struct {
+    int count;
+    int capacity;
+    int highWater;
+    int refused;            // spawns dropped because the budget was spent
+} KindBudget;
 
 typedef struct {
     float max_x;
@@ -23,29 +45,85 @@ typedef struct {
     float min_x;
     float min_y;
 
-    EntityNode* head;
-    EntityNode* tail;
+    uint64_t seed;
+    Rng rng;                // spawns and splits draw from it
+
+    EntityStore entities;
+    EntityHandle player;
+
+    // indexed by SHIP, BULLET, ASTEROID
+    KindBudget budget[3];
+
+    // dense indices of the entities that died during the tick
+    int* killList;
+
+    // asteroids bucketed for the collision broadphase
+    Grid grid;
+    int collisionPairs;     // narrowphase tests run by the last collisionDetection
     
     
-    long long timeLastSpawn;
-    int timeSpawn; // number of second before each spawn 
+    FrameClock clock;
+    float tickRate;
+    float tickDt;           // 1 / tickRate
+    double accumulator;     // frame time not simulated yet
+    float alpha;            // how far render is between the last two ticks
+    double simTime;         // seconds simulated since the start
+    uint32_t tick;          // ticks simulated since the start
+
+    // player commands waiting for the next tick
+    Command pending[MAX_TICK_COMMANDS];
+    int pendingCount;
+    Recorder* recorder;     // NULL unless the session is recorded
+
+    double timeLastSpawn;
+    float timeSpawn; // number of second before each spawn 
     int entityCount;
 
     int score;
 } World;
 
-void initWorld(World* w);
+// Same seed and same inputs, same game
+void initWorld(World* w, uint64_t seed);
+
+// Same with other budgets than MAX_BULLET and ASTEROID_CAP, the store and
+// the grid are sized for them once
+void initWorldSized(World* w, uint64_t seed, int maxBullets, int maxAsteroids);
+void freeWorld(World* w);
+
+// true if n more entities of this type fit in the world
+bool hasRoom(World* w, int type, int n);
+void printWorldStats(World* w);
+
+EntityHandle addEntity(World* w, const Entity* src);
+void removeEntity(World* w, int i);
+
+void setTickRate(World* w, float ticksPerSecond);
 
-EntityNode* addEntity(World* w, Entity* src);
-void removeEntity(World* w, EntityNode* node);
+// Queues a command for the next tick, false if too many are already waiting
+bool queueCommand(World* w, Command command);
 
+// Hash of the simulation state, two runs that agree on it played the same game
+uint32_t worldChecksum(const World* w);
+
+// Runs as many fixed ticks as the elapsed frame time calls for
 void updateWorldState(World* w);
 
+// One fixed tick of the simulation
+void stepWorld(World* w, float dt);
+
+// Phases of a tick, in the order stepWorld runs them
+void updateEntities(World* w, float dt);
+void spawnAsteroids(World* w);
+
 void collisionDetection(World* w);
 
-void bulletAsteroidCollision(World* w, EntityNode* bulletNode, EntityNode* asteroidNode);
+// Removes every entity left without lives in one batch, except the ship:
+// stepWorld restarts the game when it has none left
+void reclaimDeadEntities(World* w);
+
+void bulletAsteroidCollision(World* w, int bullet, int asteroid);
 
-void shipAsteroidCollision(EntityNode* shipNode, EntityNode* asteroidNode);
+void shipAsteroidCollision(EntityStore* s, int ship, int asteroid);
 
 
 #endif
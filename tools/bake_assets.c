@@ -0,0 +1,131 @@
+/**
+ * Offline asset baker.
+ * Decodes PNGs once, premultiplies their alpha and writes them with an
+ * index to the asset bundle the game maps at startup, see
+ * source/asset_bundle.h. Run it through `make bundle`, the web and headless
+ * builds do it before they compile.
+ *
+ * usage: bake_assets bundle image.png...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "asset_bundle.h"
+
+
+static uint32_t alignUp(uint32_t n) {
+  return (n + BUNDLE_ALIGNMENT - 1) & ~(uint32_t)(BUNDLE_ALIGNMENT - 1);
+}
+
+// Asset name: the file name without its directory and extension
+static int assetName(const char* path, char name[BUNDLE_NAME_SIZE]) {
+  const char* base = strrchr(path, '/');
+  base = base ? base + 1 : path;
+  const char* dot = strrchr(base, '.');
+  size_t length = dot ? (size_t)(dot - base) : strlen(base);
+  if (length == 0 || length >= BUNDLE_NAME_SIZE) {
+    printf("Asset name of %s must be 1 to %d characters\n", path, BUNDLE_NAME_SIZE - 1);
+    return 0;
+  }
+
+  memset(name, 0, BUNDLE_NAME_SIZE);
+  memcpy(name, base, length);
+  return 1;
+}
+
+// Rounded like the blend would: c * a / 255
+static void premultiply(unsigned char* pixels, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    unsigned char* p = pixels + i * 4;
+    unsigned a = p[3];
+    p[0] = (unsigned char)((p[0] * a + 127) / 255);
+    p[1] = (unsigned char)((p[1] * a + 127) / 255);
+    p[2] = (unsigned char)((p[2] * a + 127) / 255);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: %s bundle image.png...\n", argv[0]);
+    return 1;
+  }
+  const char* bundlePath = argv[1];
+  int count = argc - 2;
+
+  BundleEntry* entries = calloc((size_t)count, sizeof(BundleEntry));
+  unsigned char** pixels = calloc((size_t)count, sizeof(unsigned char*));
+  if (!entries || !pixels) {
+    printf("Out of memory\n");
+    return 1;
+  }
+
+  uint32_t offset = alignUp(sizeof(BundleHeader) + (uint32_t)count * sizeof(BundleEntry));
+  for (int i = 0; i < count; i++) {
+    const char* path = argv[i + 2];
+    BundleEntry* e = &entries[i];
+    if (!assetName(path, e->name)) {
+      return 1;
+    }
+    for (int j = 0; j < i; j++) {
+      if (strcmp(entries[j].name, e->name) == 0) {
+        printf("Two assets named %s\n", e->name);
+        return 1;
+      }
+    }
+
+    int width, height, channels;
+    pixels[i] = stbi_load(path, &width, &height, &channels, 4);
+    if (!pixels[i]) {
+      printf("Failed to load PNG %s\n", path);
+      return 1;
+    }
+    premultiply(pixels[i], (size_t)width * height);
+
+    e->width = (uint32_t)width;
+    e->height = (uint32_t)height;
+    e->offset = offset;
+    e->size = (uint32_t)width * (uint32_t)height * 4;
+    offset = alignUp(offset + e->size);
+  }
+
+  BundleHeader header = {BUNDLE_MAGIC, BUNDLE_VERSION, (uint32_t)count, offset};
+
+  FILE* f = fopen(bundlePath, "wb");
+  if (!f) {
+    printf("Failed to open %s for writing\n", bundlePath);
+    return 1;
+  }
+
+  // header and index, then each image at its offset
+  static const unsigned char zeros[BUNDLE_ALIGNMENT];
+  fwrite(&header, sizeof(header), 1, f);
+  fwrite(entries, sizeof(BundleEntry), (size_t)count, f);
+  uint32_t written = sizeof(header) + (uint32_t)count * sizeof(BundleEntry);
+  for (int i = 0; i < count; i++) {
+    fwrite(zeros, 1, entries[i].offset - written, f);
+    fwrite(pixels[i], 1, entries[i].size, f);
+    written = entries[i].offset + entries[i].size;
+    printf("%-24s %4ux%-4u at %u\n", entries[i].name, entries[i].width,
+           entries[i].height, entries[i].offset);
+  }
+  fwrite(zeros, 1, offset - written, f);
+
+  int failed = ferror(f);
+  if (fclose(f) != 0 || failed) {
+    printf("Failed to write %s\n", bundlePath);
+    return 1;
+  }
+  printf("bundle     %d assets   %u bytes   %s\n", count, offset, bundlePath);
+
+  for (int i = 0; i < count; i++) {
+    stbi_image_free(pixels[i]);
+  }
+  free(pixels);
+  free(entries);
+  return 0;
+}
@@ -0,0 +1,367 @@
+/**
+ * Offline atlas packer.
+ * Packs the sprites of misc/ and the glyphs of the HUD font into
+ * misc/atlas.png and writes the UV rect of each of them to source/atlas.c.
+ * Run it through `make atlas` whenever an image in misc/ or the font changes.
+ *
+ * The PNG is written with stored (uncompressed) deflate blocks so the tool
+ * only needs stb_image to read its inputs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "atlas.h"
+
+#define ATLAS_MAX_WIDTH 1024
+#define PADDING 2
+
+// Font pixels are drawn as GLYPH_SCALE x GLYPH_SCALE blocks
+#define GLYPH_COLUMNS 5
+#define GLYPH_ROWS 7
+#define GLYPH_SCALE 4
+
+typedef struct {
+    const char* path;
+    const char* name;   // SpriteId enumerator, see source/atlas.h
+    int rotate;         // turn the image a quarter turn before packing
+
+    int width;
+    int height;
+    unsigned char* pixels;
+
+    int x;
+    int y;
+} Sprite;
+
+// Same order as SpriteId in source/atlas.h.
+// The ship used to be drawn on a diamond with its UVs turned by 90 degrees,
+// it is baked turned so that every sprite is an axis aligned quad.
+static Sprite sprites[] = {
+    {"misc/ship.png",      "SPRITE_SHIP",      1, 0, 0, NULL, 0, 0},
+    {"misc/bullet.png",    "SPRITE_BULLET",    0, 0, 0, NULL, 0, 0},
+    {"misc/asteroid0.png", "SPRITE_ASTEROID0", 0, 0, 0, NULL, 0, 0},
+    {"misc/asteroid1.png", "SPRITE_ASTEROID1", 0, 0, 0, NULL, 0, 0},
+    {"misc/asteroid2.png", "SPRITE_ASTEROID2", 0, 0, 0, NULL, 0, 0},
+};
+#define IMAGE_TOTAL (int)(sizeof(sprites) / sizeof(sprites[0]))
+#define SPRITE_TOTAL (IMAGE_TOTAL + GLYPH_COUNT)
+
+typedef struct {
+    char c;
+    const char* rows[GLYPH_ROWS];   // top row first, '1' is a lit pixel
+} Glyph;
+
+// 5x7 font, every character of GLYPH_CHARSET in source/atlas.h
+static const Glyph font[] = {
+    {'0', {"01110", "10001", "10011", "10101", "11001", "10001", "01110"}},
+    {'1', {"00100", "01100", "00100", "00100", "00100", "00100", "01110"}},
+    {'2', {"01110", "10001", "00001", "00010", "00100", "01000", "11111"}},
+    {'3', {"11111", "00010", "00100", "00010", "00001", "10001", "01110"}},
+    {'4', {"00010", "00110", "01010", "10010", "11111", "00010", "00010"}},
+    {'5', {"11111", "10000", "11110", "00001", "00001", "10001", "01110"}},
+    {'6', {"00110", "01000", "10000", "11110", "10001", "10001", "01110"}},
+    {'7', {"11111", "00001", "00010", "00100", "01000", "01000", "01000"}},
+    {'8', {"01110", "10001", "10001", "01110", "10001", "10001", "01110"}},
+    {'9', {"01110", "10001", "10001", "01111", "00001", "00010", "01100"}},
+    {':', {"00000", "01100", "01100", "00000", "01100", "01100", "00000"}},
+    {'C', {"01110", "10001", "10000", "10000", "10000", "10001", "01110"}},
+    {'E', {"11111", "10000", "10000", "11110", "10000", "10000", "11111"}},
+    {'I', {"01110", "00100", "00100", "00100", "00100", "00100", "01110"}},
+    {'L', {"10000", "10000", "10000", "10000", "10000", "10000", "11111"}},
+    {'O', {"01110", "10001", "10001", "10001", "10001", "10001", "01110"}},
+    {'R', {"11110", "10001", "10001", "11110", "10100", "10010", "10001"}},
+    {'S', {"01111", "10000", "10000", "01110", "00001", "00001", "11110"}},
+    {'V', {"10001", "10001", "10001", "10001", "10001", "01010", "00100"}},
+};
+#define FONT_TOTAL (int)(sizeof(font) / sizeof(font[0]))
+
+static Sprite glyphs[GLYPH_COUNT];
+
+
+/*
+===========================================================
+                      PNG writer
+===========================================================
+*/
+
+static uint32_t crcTable[256];
+
+static void initCrc(void) {
+  for (uint32_t n = 0; n < 256; n++) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; k++) {
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    }
+    crcTable[n] = c;
+  }
+}
+
+static uint32_t crc(uint32_t c, const unsigned char* buf, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    c = crcTable[(c ^ buf[i]) & 0xff] ^ (c >> 8);
+  }
+  return c;
+}
+
+static void put32(unsigned char* p, uint32_t v) {
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+static void writeChunk(FILE* f, const char* type, const unsigned char* data, uint32_t len) {
+  unsigned char head[8];
+  put32(head, len);
+  memcpy(head + 4, type, 4);
+  fwrite(head, 1, 8, f);
+  fwrite(data, 1, len, f);
+
+  uint32_t c = crc(0xffffffffu, head + 4, 4);
+  c = crc(c, data, len) ^ 0xffffffffu;
+  unsigned char tail[4];
+  put32(tail, c);
+  fwrite(tail, 1, 4, f);
+}
+
+static int writePNG(const char* path, const unsigned char* rgba, int width, int height) {
+  // raw scanlines, each prefixed by filter type 0
+  size_t rowSize = (size_t)width * 4 + 1;
+  size_t rawSize = rowSize * height;
+  unsigned char* raw = malloc(rawSize);
+
+  // zlib stream made of stored blocks of at most 65535 bytes
+  size_t blocks = (rawSize + 65534) / 65535;
+  size_t zSize = 2 + rawSize + blocks * 5 + 4;
+  unsigned char* z = malloc(zSize);
+  if (!raw || !z) {
+    free(raw);
+    free(z);
+    return 0;
+  }
+
+  for (int y = 0; y < height; y++) {
+    raw[y * rowSize] = 0;
+    memcpy(raw + y * rowSize + 1, rgba + (size_t)y * width * 4, (size_t)width * 4);
+  }
+
+  size_t o = 0;
+  z[o++] = 0x78;
+  z[o++] = 0x01;
+  uint32_t a = 1, b = 0;
+  for (size_t done = 0; done < rawSize; ) {
+    size_t n = rawSize - done > 65535 ? 65535 : rawSize - done;
+    z[o++] = (done + n == rawSize) ? 1 : 0;
+    z[o++] = n & 0xff;
+    z[o++] = n >> 8;
+    z[o++] = ~n & 0xff;
+    z[o++] = (~n >> 8) & 0xff;
+    memcpy(z + o, raw + done, n);
+    for (size_t i = 0; i < n; i++) {
+      a = (a + raw[done + i]) % 65521;
+      b = (b + a) % 65521;
+    }
+    o += n;
+    done += n;
+  }
+  put32(z + o, (b << 16) | a);
+  o += 4;
+
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    free(raw);
+    free(z);
+    return 0;
+  }
+
+  static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  fwrite(signature, 1, 8, f);
+
+  unsigned char ihdr[13];
+  put32(ihdr, width);
+  put32(ihdr + 4, height);
+  ihdr[8] = 8;    // bit depth
+  ihdr[9] = 6;    // RGBA
+  ihdr[10] = 0;
+  ihdr[11] = 0;
+  ihdr[12] = 0;
+  writeChunk(f, "IHDR", ihdr, 13);
+  writeChunk(f, "IDAT", z, (uint32_t)o);
+  writeChunk(f, "IEND", NULL, 0);
+
+  fclose(f);
+  free(raw);
+  free(z);
+  return 1;
+}
+
+
+/*
+===========================================================
+                      Packing
+===========================================================
+*/
+
+// quarter turn: the new (u, v) shows the old (v, 1 - u)
+static void rotateSprite(Sprite* s) {
+  int w = s->height;
+  int h = s->width;
+  unsigned char* out = malloc((size_t)w * h * 4);
+
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int srcX = y;
+      int srcY = s->height - 1 - x;
+      memcpy(out + ((size_t)y * w + x) * 4,
+             s->pixels + ((size_t)srcY * s->width + srcX) * 4, 4);
+    }
+  }
+
+  stbi_image_free(s->pixels);
+  s->pixels = out;
+  s->width = w;
+  s->height = h;
+}
+
+// White pixels on transparent. The quad maps v = 0 to its bottom edge and
+// the atlas rows go down, so the rows are stored bottom first
+static int rasterizeGlyph(Sprite* s, char c) {
+  const Glyph* g = NULL;
+  for (int i = 0; i < FONT_TOTAL; i++) {
+    if (font[i].c == c) g = &font[i];
+  }
+  if (!g) {
+    printf("No glyph for '%c' in the font\n", c);
+    return 0;
+  }
+
+  s->width = GLYPH_COLUMNS * GLYPH_SCALE;
+  s->height = GLYPH_ROWS * GLYPH_SCALE;
+  s->pixels = calloc((size_t)s->width * s->height, 4);
+  if (!s->pixels) {
+    return 0;
+  }
+
+  for (int y = 0; y < s->height; y++) {
+    const char* row = g->rows[GLYPH_ROWS - 1 - y / GLYPH_SCALE];
+    for (int x = 0; x < s->width; x++) {
+      if (row[x / GLYPH_SCALE] == '1') {
+        memset(s->pixels + ((size_t)y * s->width + x) * 4, 255, 4);
+      }
+    }
+  }
+  return 1;
+}
+
+static int byHeight(const void* a, const void* b) {
+  const Sprite* sa = *(const Sprite* const*)a;
+  const Sprite* sb = *(const Sprite* const*)b;
+  return sb->height - sa->height;
+}
+
+int main(int argc, char** argv) {
+  const char* atlasPath = argc > 1 ? argv[1] : "misc/atlas.png";
+  const char* tablePath = argc > 2 ? argv[2] : "source/atlas.c";
+
+  Sprite* order[SPRITE_TOTAL];
+  for (int i = 0; i < IMAGE_TOTAL; i++) {
+    Sprite* s = &sprites[i];
+    int channels;
+    s->pixels = stbi_load(s->path, &s->width, &s->height, &channels, 4);
+    if (!s->pixels) {
+      printf("Failed to load PNG %s\n", s->path);
+      return 1;
+    }
+    if (s->rotate) {
+      rotateSprite(s);
+    }
+    order[i] = s;
+  }
+
+  for (int k = 0; k < GLYPH_COUNT; k++) {
+    if (!rasterizeGlyph(&glyphs[k], GLYPH_CHARSET[k])) {
+      return 1;
+    }
+    order[IMAGE_TOTAL + k] = &glyphs[k];
+  }
+
+  // shelf packing, tallest first
+  qsort(order, SPRITE_TOTAL, sizeof(Sprite*), byHeight);
+
+  int x = PADDING, y = PADDING, shelf = 0, width = 0;
+  for (int i = 0; i < SPRITE_TOTAL; i++) {
+    Sprite* s = order[i];
+    if (x + s->width + PADDING > ATLAS_MAX_WIDTH) {
+      x = PADDING;
+      y += shelf + PADDING;
+      shelf = 0;
+    }
+    s->x = x;
+    s->y = y;
+    x += s->width + PADDING;
+    if (s->height > shelf) shelf = s->height;
+    if (x > width) width = x;
+  }
+  int height = y + shelf + PADDING;
+
+  // multiples of 4 keep every row aligned for the upload
+  width = (width + 3) & ~3;
+  height = (height + 3) & ~3;
+
+  unsigned char* atlas = calloc((size_t)width * height, 4);
+  for (int i = 0; i < SPRITE_TOTAL; i++) {
+    Sprite* s = order[i];
+    for (int row = 0; row < s->height; row++) {
+      memcpy(atlas + ((size_t)(s->y + row) * width + s->x) * 4,
+             s->pixels + (size_t)row * s->width * 4, (size_t)s->width * 4);
+    }
+  }
+
+  initCrc();
+  if (!writePNG(atlasPath, atlas, width, height)) {
+    printf("Failed to write %s\n", atlasPath);
+    return 1;
+  }
+
+  FILE* f = fopen(tablePath, "w");
+  if (!f) {
+    printf("Failed to write %s\n", tablePath);
+    return 1;
+  }
+  fprintf(f, "// Generated by tools/pack_atlas.c, do not edit.\n\n");
+  fprintf(f, "#include \"atlas.h\"\n\n");
+  fprintf(f, "const int atlasWidth = %d;\n", width);
+  fprintf(f, "const int atlasHeight = %d;\n\n", height);
+  fprintf(f, "const float atlasRects[SPRITE_COUNT][4] = {\n");
+  for (int i = 0; i < IMAGE_TOTAL; i++) {
+    Sprite* s = &sprites[i];
+    fprintf(f, "    [%s] = {%.8ff, %.8ff, %.8ff, %.8ff},\n", s->name,
+            (float)s->x / width, (float)s->y / height,
+            (float)(s->x + s->width) / width, (float)(s->y + s->height) / height);
+  }
+  for (int k = 0; k < GLYPH_COUNT; k++) {
+    Sprite* s = &glyphs[k];
+    fprintf(f, "    [SPRITE_GLYPH_FIRST + %d] = {%.8ff, %.8ff, %.8ff, %.8ff},  // '%c'\n", k,
+            (float)s->x / width, (float)s->y / height,
+            (float)(s->x + s->width) / width, (float)(s->y + s->height) / height,
+            GLYPH_CHARSET[k]);
+  }
+  fprintf(f, "};\n");
+  fclose(f);
+
+  printf("Packed %d sprites into %s (%dx%d)\n", SPRITE_TOTAL, atlasPath, width, height);
+
+  free(atlas);
+  for (int i = 0; i < IMAGE_TOTAL; i++) {
+    free(sprites[i].pixels);
+  }
+  for (int k = 0; k < GLYPH_COUNT; k++) {
+    free(glyphs[k].pixels);
+  }
+  return 0;
+}